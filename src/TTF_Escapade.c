@@ -35,6 +35,9 @@
 #include "ttfe_game_context.h"
 #include "ttfe_particles.h"
 #include "ttfe_level.h"
+#include "ttfe_prefetch.h"
+#include "ttfe_sim.h"
+#include "ttfe_profiler.h"
 
 /* GAME CONFIGURATION */
 
@@ -61,29 +64,21 @@ float pending_mdx = 0.0f;
 float pending_mdy = 0.0f;
 float mouse_sensitivity = 0.003f;
 
-char* level_font_file = NULL;
-char* override_level_font_file = NULL;
+const char* override_level_font_file = NULL;
 int level_font_size = 128;
 ALLEGRO_FONT* level_font = NULL;
-char* gui_font_file = NULL;
-char* override_gui_font_file = NULL;
+const char* override_gui_font_file = NULL;
 int gui_font_size = 22;
 ALLEGRO_FONT* gui_font = NULL;
 
 const char* songs_file = "DATA/songs.txt";
 const char* intro_file = "DATA/intro.txt";
+const char* level_cache_dir = "CACHE";
 
-char* levels_file = NULL;
-char* override_levels_file = NULL;
+const char* override_levels_file = NULL;
 
-char* intro_sample = NULL;
-char* win_sample = NULL;
-char* falling_sample = NULL;
-char* shoot_sample = NULL;
-char* jump_sample = NULL;
-char* hit_level_sample = NULL;
-char* hit_bonus_sample = NULL;
-char* game_over_sample = NULL;
+/* app_config.json, its numbers are copied into the tuning globals at startup */
+AppConfig config;
 
 ALLEGRO_SAMPLE* music_intro = NULL;
 ALLEGRO_SAMPLE* music_win = NULL;
@@ -101,8 +96,7 @@ float speed_bonus_increment = 0.2f;
 float speed_max_limit = 3.0f;
 float bullet_speed = 150.0f;
 int bullet_delta_divider = 4;
-float obstacle_spawn_timer = 0.0f;
-float obstacle_spawn_delay = 4.0f; /* Une boite toutes les 2 secondes */
+float obstacle_spawn_delay = SIM_OBSTACLE_SPAWN_DELAY;
 
 int getoptret = 0;
 
@@ -112,6 +106,10 @@ int log_level = LOG_ERR;
 
 bool do_draw = 1, do_logic = 1;
 
+/* fixed step logic: ticks run per wake-up at most, and late time kept at most (seconds) */
+#define LOGIC_MAX_STEPS 8
+#define LOGIC_MAX_BACKLOG 0.25
+
 void usage(int log_level, char* progname) {
     n_log(log_level,
           "\n    %s usage:\n"
@@ -147,20 +145,8 @@ int main(int argc, char** argv) {
                 exit(TRUE);
                 break;
             case 'V':
-                if (!strncmp("INFO", optarg, 6))
-                    log_level = LOG_INFO;
-                else if (!strncmp("NOTICE", optarg, 6))
-                    log_level = LOG_NOTICE;
-                else if (!strncmp("VERBOSE", optarg, 7))
-                    log_level = LOG_NOTICE;
-                else if (!strncmp("ERROR", optarg, 5))
-                    log_level = LOG_ERR;
-                else if (!strncmp("DEBUG", optarg, 5))
-                    log_level = LOG_DEBUG;
-                else {
-                    n_log(LOG_ERR, "%s is not a valid log level", optarg);
+                if ((log_level = app_config_log_level(optarg)) < 0)
                     exit(FALSE);
-                }
                 n_log(LOG_NOTICE, "LOG LEVEL UP TO: %d", log_level);
                 set_log_level(log_level);
                 break;
@@ -170,15 +156,15 @@ int main(int argc, char** argv) {
                 break;
             case 'l':
                 n_log(LOG_NOTICE, "LEVEL FILE: %s", optarg);
-                override_levels_file = strdup(optarg);
+                override_levels_file = optarg;
                 break;
             case 'f':
                 n_log(LOG_NOTICE, "LEVEL FONT FILE: %s", optarg);
-                override_level_font_file = strdup(optarg);
+                override_level_font_file = optarg;
                 break;
             case 'g':
                 n_log(LOG_NOTICE, "GUI FONT FILE: %s", optarg);
-                override_gui_font_file = strdup(optarg);
+                override_gui_font_file = optarg;
                 break;
             case '?':
                 if (optopt == 'V') {
@@ -196,32 +182,31 @@ int main(int argc, char** argv) {
     set_log_level(log_level);
 #ifdef __EMSCRIPTEN__
     set_log_file_fd(stdout);
+#else
+    /* the frame loop and the level build threads only format their logs, a thread writes them */
+    if (!set_log_async(TRUE))
+        n_log(LOG_ERR, "could not start the log writer thread, logging synchronously");
 #endif
 
     /* Load config */
-    if (load_app_config("DATA/app_config.json", &WIDTH, &HEIGHT, &fullscreen,
-                        &intro_sample, &win_sample, &falling_sample, &shoot_sample, &jump_sample,
-                        &hit_level_sample, &hit_bonus_sample, &game_over_sample,
-                        &fps, &logic,
-                        &level_font_file, &level_font_size, &gui_font_file, &gui_font_size, &levels_file,
-                        &gravity, &jump_vel, &base_speed, &speed_bonus_increment, &speed_max_limit,
-                        &mouse_sensitivity, &bullet_speed, &bullet_delta_divider) != TRUE) {
-        n_log(LOG_ERR, "couldn't load app_config.json!");
+    if (app_config_load(&config, "DATA/app_config.json", override_level_font_file, override_gui_font_file, override_levels_file) != TRUE) {
         exit(1);
     }
-
-    if (override_level_font_file) {
-        Free(level_font_file);
-        level_font_file = override_level_font_file;
-    }
-    if (override_gui_font_file) {
-        Free(gui_font_file);
-        gui_font_file = override_gui_font_file;
-    }
-    if (override_levels_file) {
-        Free(levels_file);
-        levels_file = override_levels_file;
-    }
+    WIDTH = config.width;
+    HEIGHT = config.height;
+    fullscreen = config.fullscreen;
+    fps = config.fps;
+    logic = config.logic;
+    level_font_size = config.level_font_size;
+    gui_font_size = config.gui_font_size;
+    gravity = config.gravity;
+    jump_vel = config.jump_vel;
+    base_speed = config.base_speed;
+    speed_bonus_increment = config.speed_bonus_increment;
+    speed_max_limit = config.speed_max_limit;
+    mouse_sensitivity = config.mouse_sensitivity;
+    bullet_speed = config.bullet_speed;
+    bullet_delta_divider = config.bullet_delta_divider;
 
     srand((unsigned int)time(NULL));
 
@@ -268,7 +253,15 @@ int main(int argc, char** argv) {
     GameContext ctx;
     game_context_init(&ctx, base_speed);
     ctx.display = display;
-    ttfe_vbo_init(&ctx.g_ttfe_stream_vbo, 16382);
+    /* room for TTFE_VBO_RING_FRAMES frames of stars, pink lights, boxes and particles, grown if needed */
+    ttfe_vbo_init_ring(&ctx.g_ttfe_stream_vbo, 65536, 98304);
+    ttfe_tint_init(&ctx.glow_tint);
+    if (!starfield_mesh_init_shader(&ctx.starfield))
+        n_log(LOG_NOTICE, "no starfield shader, twinkling the stars on the CPU");
+
+    /* Next level background preparation */
+    LevelPrefetch prefetch;
+    level_prefetch_init(&prefetch);
 
     al_set_window_title(display, "TrueTypeFont Escapade");
 
@@ -302,13 +295,12 @@ int main(int argc, char** argv) {
 #endif
 
     /* Load intro text */
-    int intro_count = 0;
-    char** intro_lines = load_text_file_lines(intro_file, &intro_count);
+    TextFile intro_text;
+    bool intro_ok = text_file_open(&intro_text, intro_file);
 
     /* Load levels */
-    int level_count = 0;
-    char** levels = load_text_file_lines(levels_file, &level_count);
-    if (!levels) {
+    TextFile levels_text;
+    if (!text_file_open(&levels_text, config.levels_file)) {
         game_context_free(&ctx);
         al_destroy_timer(fps_timer);
         al_destroy_timer(logic_timer);
@@ -316,65 +308,61 @@ int main(int argc, char** argv) {
         al_destroy_display(display);
         return FALSE;
     }
+    const TextSpan* levels = levels_text.lines;
+    int level_count = levels_text.line_count;
     ctx.level_count = level_count;
 
     /* Load songs */
-    int songs_count = 0;
-    char** songs = NULL;
+    TextFile songs_text;
+    memset(&songs_text, 0, sizeof(TextFile));
     if (audio_ok) {
-        songs = load_text_file_lines(songs_file, &songs_count);
+        text_file_open(&songs_text, songs_file);
     }
+    const TextSpan* songs = songs_text.lines;
+    int songs_count = songs_text.line_count;
 
     /* Load fonts */
-    level_font = al_load_ttf_font(level_font_file, level_font_size, 0);
+    level_font = al_load_ttf_font(config.level_font_file, level_font_size, 0);
     if (!level_font) {
         n_log(LOG_ERR, "Failed to load level font");
         game_context_free(&ctx);
         return FALSE;
     }
+    level_cache_init(&ctx.level_cache, level_cache_dir, config.level_font_file);
 
-    gui_font = al_load_ttf_font(gui_font_file, gui_font_size, 0);
+    gui_font = al_load_ttf_font(config.gui_font_file, gui_font_size, 0);
     if (!gui_font) {
         gui_font = al_create_builtin_font();
     }
 
     /* Initialize intro snow */
-    for (int i = 0; i < INTRO_SNOW_COUNT; ++i) {
-        GameEntity* snow = pool_alloc(&ctx.intro_snow);
-        if (snow) {
-            entity_init_snowflake(snow,
-                                  frandf(0.0f, (float)ctx.dw),
-                                  frandf(-(float)ctx.dh, 0.0f),
-                                  frandf(30.0f, 80.0f),
-                                  frandf(2.0f, 6.0f));
-        }
-    }
+    spawn_intro_snow(&ctx);
 
     /* Load audio samples */
     if (audio_ok) {
-        if (!(sfx_shoot = al_load_sample(shoot_sample))) {
-            n_log(LOG_ERR, "could not load %s, %s", shoot_sample, strerror(al_get_errno()));
+        if (!(sfx_shoot = al_load_sample(config.shoot_sample))) {
+            n_log(LOG_ERR, "could not load %s, %s", config.shoot_sample, strerror(al_get_errno()));
         }
-        if (!(sfx_jump = al_load_sample(jump_sample))) {
-            n_log(LOG_ERR, "could not load %s, %s", jump_sample, strerror(al_get_errno()));
+        if (!(sfx_jump = al_load_sample(config.jump_sample))) {
+            n_log(LOG_ERR, "could not load %s, %s", config.jump_sample, strerror(al_get_errno()));
         }
-        if (!(sfx_hit_level = al_load_sample(hit_level_sample))) {
-            n_log(LOG_ERR, "could not load %s, %s", hit_level_sample, strerror(al_get_errno()));
+        if (!(sfx_hit_level = al_load_sample(config.hit_level_sample))) {
+            n_log(LOG_ERR, "could not load %s, %s", config.hit_level_sample, strerror(al_get_errno()));
         }
-        if (!(sfx_hit_bonus = al_load_sample(hit_bonus_sample))) {
-            n_log(LOG_ERR, "could not load %s, %s", hit_bonus_sample, strerror(al_get_errno()));
+        if (!(sfx_hit_bonus = al_load_sample(config.hit_bonus_sample))) {
+            n_log(LOG_ERR, "could not load %s, %s", config.hit_bonus_sample, strerror(al_get_errno()));
         }
-        if (!(sfx_falling = al_load_sample(falling_sample))) {
-            n_log(LOG_ERR, "could not load %s, %s", falling_sample, strerror(al_get_errno()));
+        if (!(sfx_falling = al_load_sample(config.falling_sample))) {
+            n_log(LOG_ERR, "could not load %s, %s", config.falling_sample, strerror(al_get_errno()));
         }
-        if (!(sfx_game_over = al_load_sample(game_over_sample))) {
-            n_log(LOG_ERR, "could not load %s, %s", game_over_sample, strerror(al_get_errno()));
+        if (!(sfx_game_over = al_load_sample(config.game_over_sample))) {
+            n_log(LOG_ERR, "could not load %s, %s", config.game_over_sample, strerror(al_get_errno()));
         }
-        if (!(music_intro = al_load_sample(intro_sample))) {
-            n_log(LOG_ERR, "could not load %s, %s", intro_sample, strerror(al_get_errno()));
+        if (!(music_intro = al_load_sample(config.intro_sample))) {
+            n_log(LOG_ERR, "could not load %s, %s", config.intro_sample, strerror(al_get_errno()));
         }
-        if (!(music_win = al_load_sample(win_sample))) {
-            n_log(LOG_ERR, "could not load %s, %s", win_sample, strerror(al_get_errno()));
+        if (!(music_win = al_load_sample(config.win_sample))) {
+            n_log(LOG_ERR, "could not load %s, %s", config.win_sample, strerror(al_get_errno()));
         }
     } else {
         n_log(LOG_ERR, "not loading musics and samples as audio is not correctly initialized");
@@ -389,7 +377,7 @@ int main(int argc, char** argv) {
     al_start_timer(logic_timer);
 
     /*  INTRO SCREEN  */
-    if (intro_count > 0 && audio_ok && music_intro) {
+    if (intro_ok && audio_ok && music_intro) {
         music_intro_instance = al_create_sample_instance(music_intro);
         if (music_intro_instance) {
             al_set_sample_instance_playmode(music_intro_instance, ALLEGRO_PLAYMODE_LOOP);
@@ -398,7 +386,7 @@ int main(int argc, char** argv) {
         }
     }
 
-    bool in_intro = (intro_count > 0);
+    bool in_intro = intro_ok;
     while (in_intro) {
         ALLEGRO_EVENT ev;
         al_wait_for_event(queue, &ev);
@@ -439,9 +427,7 @@ int main(int argc, char** argv) {
             light_phase += dt;
 
             /* Update intro snow */
-            for (int i = 0; i < ctx.intro_snow.capacity; ++i) {
-                entity_update_snowflake(&ctx.intro_snow.entities[i], dt, (float)ctx.dh);
-            }
+            update_intro_snow(&ctx, dt);
             do_logic = 0;
         }
 
@@ -452,16 +438,16 @@ int main(int argc, char** argv) {
             render_intro_snow(&ctx);
 
             /* Draw intro text */
-            if (intro_lines) {
+            if (intro_ok) {
                 int line_h = gui_font_size + 4;
-                int total_h = line_h * intro_count;
+                int total_h = line_h * intro_text.line_count;
                 int y0 = (ctx.dh - 120 - total_h) / 2;
                 if (y0 < 0) y0 = 0;
 
-                for (int i = 0; i < intro_count; ++i) {
+                for (int i = 0; i < intro_text.line_count; ++i) {
                     al_draw_text(gui_font, al_map_rgb(255, 255, 255),
                                  10, y0 + i * line_h,
-                                 ALLEGRO_ALIGN_LEFT, intro_lines[i]);
+                                 ALLEGRO_ALIGN_LEFT, intro_text.lines[i].ptr);
                 }
             }
 
@@ -473,6 +459,7 @@ int main(int argc, char** argv) {
                          ALLEGRO_ALIGN_CENTRE, "ESC to quit");
 
             al_flip_display();
+            ttfe_vbo_ring_frame(&ctx.g_ttfe_stream_vbo);
             do_draw = 0;
         }
     }
@@ -483,52 +470,82 @@ int main(int argc, char** argv) {
         music_intro_instance = NULL;
     }
 
+    /* Logic tick state */
+    SimParams sim_params = {gravity, speed_bonus_increment, speed_max_limit, obstacle_spawn_delay};
+    SimState sim;
+    memset(&sim, 0, sizeof(SimState));
+
+    /* F2 profiler overlay */
+    Profiler profiler;
+    profiler_init(&profiler);
+
     /*  MAIN GAME LOOP  */
     for (ctx.level_index = 0; ctx.level_index < level_count; ++ctx.level_index) {
-        bool score_counted = false;
 
         /* Parse level config */
-        char** level_split = split(levels[ctx.level_index], " ", 0);
-        if (!level_split || split_count(level_split) < 4) {
+        TextSpan level_tokens[LEVEL_LINE_TOKENS];
+        if (text_span_tokens(levels[ctx.level_index], level_tokens, LEVEL_LINE_TOKENS) < LEVEL_LINE_TOKENS) {
             n_log(LOG_ERR, "error splitting level line");
             ctx.party_result = PARTY_FAILED;
             break;
         }
 
-        char* phrase = strdup(level_split[0]);
-        int phrase_len = (int)strlen(phrase);
+        /* tokens point into levels_text, valid until the cleanup */
+        const char* phrase = level_tokens[0].ptr;
+        int phrase_len = (int)level_tokens[0].len;
 
         int tmpval;
-        if (str_to_int(level_split[1], &tmpval, 10) == TRUE && (tmpval == 0 || tmpval == 1))
+        if (str_to_int(level_tokens[1].ptr, &tmpval, 10) == TRUE && (tmpval == 0 || tmpval == 1))
             COLOR_CYCLE_GOAL = tmpval;
-        if (str_to_int(level_split[2], &tmpval, 10) == TRUE && (tmpval == 0 || tmpval == 1))
+        if (str_to_int(level_tokens[2].ptr, &tmpval, 10) == TRUE && (tmpval == 0 || tmpval == 1))
             PULSE_TEXT = tmpval;
-        if (str_to_int(level_split[3], &tmpval, 10) == TRUE && (tmpval == 0 || tmpval == 1))
+        if (str_to_int(level_tokens[3].ptr, &tmpval, 10) == TRUE && (tmpval == 0 || tmpval == 1))
             BLEND_TEXT = tmpval;
 
-        free_split_result(&level_split);
-
         /* Reset level state */
         n_log(LOG_DEBUG, "Level %d: game_context_reset_level...", ctx.level_index + 1);
         game_context_reset_level(&ctx);
 
-        /* Build level */
-        n_log(LOG_DEBUG, "Level %d: build_level_geometry for: %s", ctx.level_index + 1, phrase);
-        if (!build_level_geometry(&ctx, level_font, gui_font, phrase, phrase_len, level_font_size)) {
+        /* Build level, or take it from the background prefetch */
+        ALLEGRO_SAMPLE* prefetched_song = NULL;
+        bool prefetched = level_prefetch_take(&prefetch, &ctx, ctx.level_index, &prefetched_song);
+        if (prefetched) {
+            n_log(LOG_DEBUG, "Level %d: using prefetched level for: %s", ctx.level_index + 1, phrase);
+        } else {
+            n_log(LOG_DEBUG, "Level %d: build_level_geometry for: %s", ctx.level_index + 1, phrase);
+            if (!build_level_geometry(&ctx, level_font, gui_font, phrase, phrase_len, level_font_size)) {
+                goto cleanup;
+            }
+        }
+
+        /* Distance field for the collision tests */
+        if (!voxel_field_build_distance(&ctx.vf)) {
+            n_log(LOG_ERR, "no distance field, using plain collision tests");
+        }
+        if (!box_grid_setup(&ctx.box_grid, &ctx.vf)) {
+            n_log(LOG_ERR, "unable to allocate the box grid");
             goto cleanup;
         }
 
-        /* Generate starfield */
-        n_log(LOG_DEBUG, "Level %d: generate_starfield...", ctx.level_index + 1);
-        float level_w = ctx.vf.gw * ctx.vf.cell_size;
-        float level_d = ctx.vf.gh * ctx.vf.cell_size;
-        float level_radius = 0.5f * sqrtf(level_w * level_w + level_d * level_d);
-        float min_r = level_radius + 50.0f;
-        float max_r = level_radius + 250.0f;
+        /* Sort the meshes by chunk for frustum culling, before they are uploaded */
+        if (!level_chunks_build(&ctx.chunks_level, &ctx.vf, &ctx.va_level) ||
+            !level_chunks_build(&ctx.chunks_overlay_letters, &ctx.vf, &ctx.va_overlay_letters) ||
+            !level_chunks_build(&ctx.chunks_overlay_goals, &ctx.vf, &ctx.va_overlay_goals)) {
+            n_log(LOG_ERR, "no level chunks, drawing the whole level");
+        }
+
+        /* Upload static level geometry */
+        n_log(LOG_DEBUG, "Level %d: upload level geometry (%d vertices)...", ctx.level_index + 1, ctx.va_level.count);
+        if (!vbo_upload_static(&ctx.vbo_level, &ctx.va_level)) {
+            n_log(LOG_ERR, "no static buffer for level geometry, streaming it each frame");
+        }
+        vbo_upload_static(&ctx.vbo_overlay_letters, &ctx.va_overlay_letters);
+        vbo_upload_static(&ctx.vbo_overlay_goals, &ctx.va_overlay_goals);
 
-        int star_count = 128 + 120 * phrase_len;
-        if (star_count > STAR_COUNT) star_count = STAR_COUNT;
-        generate_starfield(&ctx.stars, star_count, min_r, max_r);
+        /* Generate starfield, here even for a prefetched level: rand() must stay on this thread */
+        n_log(LOG_DEBUG, "Level %d: generate_starfield...", ctx.level_index + 1);
+        generate_level_starfield(&ctx.stars, &ctx.vf, phrase_len);
+        starfield_mesh_build(&ctx.starfield, &ctx.stars);
 
         /* Place boxes and lights */
         n_log(LOG_DEBUG, "Level %d: place_boxes_and_lights...", ctx.level_index + 1);
@@ -546,9 +563,19 @@ int main(int argc, char** argv) {
         }
 #endif
 
+        /* Prepare the next level in the background while this one is played */
+        if (ctx.level_index + 1 < level_count) {
+            TextSpan next_tokens[LEVEL_LINE_TOKENS];
+            if (text_span_tokens(levels[ctx.level_index + 1], next_tokens, LEVEL_LINE_TOKENS) >= LEVEL_LINE_TOKENS) {
+                const char* next_song = (audio_ok && songs && ctx.level_index + 1 < songs_count) ? songs[ctx.level_index + 1].ptr : NULL;
+                if (level_prefetch_start(&prefetch, &ctx.level_cache, ctx.level_index + 1, level_font, next_tokens[0].ptr, level_font_size, next_song))
+                    n_log(LOG_DEBUG, "Level %d: prefetching level %d", ctx.level_index + 1, ctx.level_index + 2);
+            }
+        }
+
         /* Start level music */
         if (audio_ok && songs && ctx.level_index < songs_count) {
-            current_sample = al_load_sample(songs[ctx.level_index]);
+            current_sample = prefetched ? prefetched_song : al_load_sample(songs[ctx.level_index].ptr);
             if (current_sample) {
                 current_sample_instance = al_create_sample_instance(current_sample);
                 if (current_sample_instance) {
@@ -557,31 +584,20 @@ int main(int argc, char** argv) {
                     al_play_sample_instance(current_sample_instance);
                 }
             } else {
-                n_log(LOG_ERR, "unable to load song %s", songs[ctx.level_index]);
+                n_log(LOG_ERR, "unable to load song %s", songs[ctx.level_index].ptr);
             }
         }
 
         /* Level state variables */
-        int level_boxes_hit = 0;
-        int level_time_bonus_boxes = 0;
-        int level_speed_bonus_boxes = 0;
-        bool time_over = false;
-        bool fell_out = false;
+        sim_level_start(&sim);
         bool game_over_played = false;
         bool winning_music_started = false;
-        bool was_above_top = true;
-        bool save_jump_available = false;
-
-        const float TOP_Y = ctx.vf.extrude_h;
-        const float FALL_DEATH_Y = -10.0f;
-        const float SAVE_JUMP_MIN_Y = -5.0f;
 
         int keys[ALLEGRO_KEY_MAX] = {0};
         bool leaving_level = false;
         bool restart_level = false;
 
         n_log(LOG_DEBUG, "Starting level %d: %s", ctx.level_index + 1, phrase);
-        Free(phrase);
 
         /* flush queue to eliminate all unecessary events accumulated during loading phases */
         ALLEGRO_EVENT flush_ev;
@@ -601,13 +617,22 @@ int main(int argc, char** argv) {
         }
         al_flush_event_queue(queue);
 
+        /* fixed step clock, restarted once the level is loaded */
+        const float logic_dt = 1.0f / logic;
+        double logic_clock = al_get_time();
+        double logic_accumulator = 0.0;
+        float render_alpha = 1.0f;
+
         /* Level event loop */
         while (!leaving_level) {
             ALLEGRO_EVENT ev;
             al_wait_for_event(queue, &ev);
+            profiler_start(&profiler);
             if (ev.type == ALLEGRO_EVENT_TIMER) {
                 if (al_get_timer_event_source(fps_timer) == ev.any.source) {
+                    /* catch up the logic before drawing */
                     do_draw = 1;
+                    do_logic = 1;
                 } else if (al_get_timer_event_source(logic_timer) == ev.any.source) {
                     do_logic = 1;
                 }
@@ -658,6 +683,10 @@ If the browser refuses, the click callback will acquire it on next click.
                         ctx.cheat_code_used = true;
                     }
                     n_log(LOG_DEBUG, "CHEATCODE gravity_enabled = %d", ctx.gravity_enabled);
+                } else if (kc == ALLEGRO_KEY_F2) {
+                    /* Toggle profiler overlay */
+                    profiler_toggle(&profiler);
+                    n_log(LOG_DEBUG, "profiler overlay = %d", profiler.enabled);
                 } else if (kc == ALLEGRO_KEY_1) {
                     /* Toggle goal color cycling */
                     COLOR_CYCLE_GOAL = !COLOR_CYCLE_GOAL;
@@ -670,6 +699,10 @@ If the browser refuses, the click callback will acquire it on next click.
                     /* Toggle blend mode */
                     BLEND_TEXT = !BLEND_TEXT;
                     n_log(LOG_DEBUG, "CHEATCODE BLEND_TEXT = %d", BLEND_TEXT);
+                } else if (kc == ALLEGRO_KEY_4) {
+                    /* Toggle projectile trails */
+                    ctx.projectile_trails = !ctx.projectile_trails;
+                    n_log(LOG_DEBUG, "projectile_trails = %d", ctx.projectile_trails);
                 } else if (kc == ALLEGRO_KEY_T) {
                     /* Time bonus cheat */
                     n_log(LOG_DEBUG, "CHEATCODE TIME +30s !!");
@@ -687,22 +720,9 @@ If the browser refuses, the click callback will acquire it on next click.
                     ctx.cheat_code_used = true;
                 } else if (kc == ALLEGRO_KEY_SPACE) {
                     if (!ctx.paused && ctx.state == STATE_PLAY) {
-                        if (ctx.gravity_enabled) {
-                            if (ctx.on_ground) {
-                                ctx.vertical_vel = jump_vel;
-                                ctx.on_ground = false;
-                                if (audio_ok && sfx_jump) {
-                                    al_play_sample(sfx_jump, 1.0f, 0.0f, 1.0f, ALLEGRO_PLAYMODE_ONCE, NULL);
-                                }
-                            } else if (save_jump_available) {
-                                float bottom = ctx.cam.position.y - ctx.cam_half_height;
-                                if (bottom > SAVE_JUMP_MIN_Y) {
-                                    ctx.vertical_vel = jump_vel;
-                                }
-                                save_jump_available = false;
-                                if (audio_ok && sfx_jump) {
-                                    al_play_sample(sfx_jump, 1.0f, 0.0f, 1.0f, ALLEGRO_PLAYMODE_ONCE, NULL);
-                                }
+                        if (ctx.gravity_enabled && sim_jump(&ctx, &sim, jump_vel)) {
+                            if (audio_ok && sfx_jump) {
+                                al_play_sample(sfx_jump, 1.0f, 0.0f, 1.0f, ALLEGRO_PLAYMODE_ONCE, NULL);
                             }
                         }
                         keys[ALLEGRO_KEY_SPACE] = 1;
@@ -782,35 +802,9 @@ If the browser refuses, the click callback will acquire it on next click.
                 }
 #endif
             }
+            profiler_mark(&profiler, PROF_EVENTS);
 
             if (do_logic) {
-                const float dt = 1.0f / logic;
-
-                /* Update timer */
-                if (ctx.state == STATE_PLAY && !ctx.paused) {
-                    ctx.time_remaining -= dt;
-                    if (ctx.time_remaining <= 0.0f && !time_over) {
-                        ctx.time_remaining = 0.0f;
-                        ctx.state = STATE_PARTY_END;
-                        time_over = true;
-                        ctx.party_result = PARTY_FAILED;
-
-                        if (!game_over_played && audio_ok && sfx_game_over) {
-                            if (current_sample_instance) {
-                                al_stop_sample_instance(current_sample_instance);
-                                al_destroy_sample_instance(current_sample_instance);
-                                current_sample_instance = NULL;
-                            }
-                            if (current_sample) {
-                                al_destroy_sample(current_sample);
-                                current_sample = NULL;
-                            }
-                            al_play_sample(sfx_game_over, 1.0f, 0.0f, 1.0f, ALLEGRO_PLAYMODE_ONCE, NULL);
-                            game_over_played = true;
-                        }
-                    }
-                }
-
                 /* Mouse look */
 #ifndef __EMSCRIPTEN__
                 if (ctx.mouse_locked && ctx.state == STATE_PLAY && !ctx.paused)
@@ -835,245 +829,69 @@ If the browser refuses, the click callback will acquire it on next click.
                     }
                 }
 
-                /* Movement */
-                if (ctx.state == STATE_PLAY && !ctx.paused) {
-                    Vec3 forward3 = camera_forward(&ctx.cam);
-                    Vec3 right3 = camera_right(&ctx.cam);
-
-                    ctx.move_forward = ctx.move_lateral = 0.0f;
-                    if (keys[ALLEGRO_KEY_W] || keys[ALLEGRO_KEY_UP] || keys[ALLEGRO_KEY_Z])
-                        ctx.move_forward += ctx.move_speed;
-                    if (keys[ALLEGRO_KEY_S] || keys[ALLEGRO_KEY_DOWN])
-                        ctx.move_forward -= ctx.move_speed;
-                    if (keys[ALLEGRO_KEY_D] || keys[ALLEGRO_KEY_RIGHT])
-                        ctx.move_lateral += ctx.move_speed;
-                    if (keys[ALLEGRO_KEY_A] || keys[ALLEGRO_KEY_LEFT] || keys[ALLEGRO_KEY_Q])
-                        ctx.move_lateral -= ctx.move_speed;
-
-                    bool prev_on_ground = ctx.on_ground;
-                    Vec3 disp = v_zero();
-
-                    if (ctx.gravity_enabled) {
-                        Vec3 forward_flat = v_normalize(v_make(forward3.x, 0.0f, forward3.z));
-                        Vec3 right_flat = v_normalize(v_make(right3.x, 0.0f, right3.z));
-
-                        disp = v_add(disp, v_scale(forward_flat, ctx.move_forward));
-                        disp = v_add(disp, v_scale(right_flat, ctx.move_lateral));
-
-                        ctx.vertical_vel += gravity * dt;
-                        disp.y += ctx.vertical_vel * dt;
-                    } else {
-                        disp = v_add(disp, v_scale(forward3, ctx.move_forward));
-                        disp = v_add(disp, v_scale(right3, ctx.move_lateral));
-
-                        if (keys[ALLEGRO_KEY_SPACE])
-                            disp.y += ctx.move_speed;
+                /* Fixed step: run the ticks due since the last wake-up, a bounded number at a time.
+                   A longer backlog is carried over to the next wake-ups, and dropped past LOGIC_MAX_BACKLOG */
+                double now = al_get_time();
+                logic_accumulator += now - logic_clock;
+                logic_clock = now;
+                if (logic_accumulator > LOGIC_MAX_BACKLOG) logic_accumulator = LOGIC_MAX_BACKLOG;
+
+                for (int step = 0; step < LOGIC_MAX_STEPS && logic_accumulator >= logic_dt; step++) {
+                    /* Logic tick */
+                    SimInput input = {
+                        keys[ALLEGRO_KEY_W] || keys[ALLEGRO_KEY_UP] || keys[ALLEGRO_KEY_Z],
+                        keys[ALLEGRO_KEY_S] || keys[ALLEGRO_KEY_DOWN],
+                        keys[ALLEGRO_KEY_A] || keys[ALLEGRO_KEY_LEFT] || keys[ALLEGRO_KEY_Q],
+                        keys[ALLEGRO_KEY_D] || keys[ALLEGRO_KEY_RIGHT],
+                        keys[ALLEGRO_KEY_SPACE]};
+                    int events = sim_tick(&ctx, &sim, &sim_params, &input, logic_dt, sfx_hit_level, sfx_hit_bonus, audio_ok, NULL);
+
+                    if ((events & SIM_EVENT_FALLING) && audio_ok && sfx_falling) {
+                        al_play_sample(sfx_falling, 1.0f, 0.0f, 1.0f, ALLEGRO_PLAYMODE_ONCE, NULL);
                     }
 
-                    /* Update obstacles */
-                    Vec3 hit_move = v_make(0.0f, 0.0f, 0.0f);
-                    if (ctx.state == STATE_PLAY && !ctx.paused) {
-                        /* Spawn Obstacles */
-                        obstacle_spawn_timer += dt;
-                        if (obstacle_spawn_timer >= obstacle_spawn_delay) {
-                            obstacle_spawn_timer = 0.0f;
-
-                            /* Spawn at the end of the level geometry */
-                            float end_x = ctx.vf.origin_x + ctx.vf.gw * ctx.vf.cell_size;
-                            float z_span = ctx.vf.gh * ctx.vf.cell_size;
-
-                            /* Random Z position within level width */
-                            float spawn_z = ctx.vf.origin_z + frandf(0.0f, z_span);
-
-                            /* Random Size */
-                            float size = frandf(2.5f, 6.0f);
-
-                            GameEntity* obs = pool_alloc(&ctx.boxes);
-                            if (obs) {
-                                /* speed (negative X) */
-                                Vec3 vel = v_make(-frandf(20.0f, 60.0f), 0.0f, 0.0f);
-                                /* Y over the surface of the letters */
-                                Vec3 pos = v_make(end_x, ctx.vf.extrude_h + size, spawn_z);
-                                entity_init_obstacle(obs, pos, vel, size);
-                            }
+                    if ((events & SIM_EVENT_GAME_OVER) && !game_over_played && audio_ok && sfx_game_over) {
+                        if (current_sample_instance) {
+                            al_stop_sample_instance(current_sample_instance);
+                            al_destroy_sample_instance(current_sample_instance);
+                            current_sample_instance = NULL;
                         }
-
-                        /* Update boxes and boxes collisions */
-                        for (int i = 0; i < ctx.boxes.capacity; ++i) {
-                            GameEntity* box = &ctx.boxes.entities[i];
-                            if (!entity_is_active(box) || !(box->flags & ENTITY_FLAG_OBSTACLE)) continue;
-
-                            /* Box move */
-                            box->pos = v_add(box->pos, v_scale(box->vel, dt));
-
-                            /* collision */
-                            if (capsule_aabb_collides(ctx.cam.position, ctx.cam_radius, ctx.cam_half_height, box->pos, box->size)) {
-                                /* add box move to player */
-                                hit_move.x += box->vel.x * dt;
-                                /* Feedback effects (optional) */
-                                ctx.cam.pitch += frandf(-0.02f, 0.02f);
-                                ctx.cam.yaw += frandf(-0.02f, 0.02f);
-                            }
-
-                            /* if bump box is out of the map, kill it */
-                            if (box->pos.x < ctx.vf.origin_x - 30.0f) {
-                                entity_deactivate(box);
-                            }
+                        if (current_sample) {
+                            al_destroy_sample(current_sample);
+                            current_sample = NULL;
                         }
+                        al_play_sample(sfx_game_over, 1.0f, 0.0f, 1.0f, ALLEGRO_PLAYMODE_ONCE, NULL);
+                        game_over_played = true;
                     }
 
-                    if (v_norm(disp) > 1e-5f) {
-                        Vec3 pos = ctx.cam.position;
-
-                        /* X axis */
-                        Vec3 test_pos = pos;
-                        test_pos.x += disp.x + hit_move.x;
-                        if (!capsule_collides(&ctx.vf, test_pos, ctx.cam_radius, ctx.cam_half_height)) {
-                            pos.x = test_pos.x;
+                    if ((events & SIM_EVENT_GOAL) && !winning_music_started && audio_ok && music_win) {
+                        if (current_sample_instance) {
+                            al_stop_sample_instance(current_sample_instance);
+                            al_destroy_sample_instance(current_sample_instance);
+                            current_sample_instance = NULL;
                         }
-
-                        /* Z axis */
-                        test_pos = pos;
-                        test_pos.z += disp.z + hit_move.z;
-                        if (!capsule_collides(&ctx.vf, test_pos, ctx.cam_radius, ctx.cam_half_height)) {
-                            pos.z = test_pos.z;
+                        if (current_sample) {
+                            al_destroy_sample(current_sample);
+                            current_sample = NULL;
                         }
-
-                        /* Y axis */
-                        test_pos = pos;
-                        test_pos.y += disp.y + hit_move.y;
-                        if (!capsule_collides(&ctx.vf, test_pos, ctx.cam_radius, ctx.cam_half_height)) {
-                            pos.y = test_pos.y;
-                            if (ctx.gravity_enabled)
-                                ctx.on_ground = false;
-                        } else {
-                            if (ctx.gravity_enabled) {
-                                if (disp.y < 0.0f)
-                                    ctx.on_ground = true;
-                                ctx.vertical_vel = 0.0f;
-                            }
-                        }
-
-                        ctx.cam.position = pos;
-
-                        /* Fall detection */
-                        if (ctx.gravity_enabled) {
-                            float bottom = ctx.cam.position.y - ctx.cam_half_height;
-
-                            if (prev_on_ground && !ctx.on_ground) {
-                                int gx, gy;
-                                world_to_grid(&ctx.vf, ctx.cam.position.x, ctx.cam.position.z, &gx, &gy);
-                                bool near_solid = false;
-                                for (int dy = -1; dy <= 1 && !near_solid; ++dy) {
-                                    for (int dx = -1; dx <= 1; ++dx) {
-                                        if (is_solid(&ctx.vf, gx + dx, gy + dy)) {
-                                            near_solid = true;
-                                            break;
-                                        }
-                                    }
-                                }
-                                save_jump_available = (near_solid && bottom > SAVE_JUMP_MIN_Y);
-                            }
-
-                            if (ctx.on_ground)
-                                save_jump_available = false;
-
-                            if (bottom > TOP_Y + 0.1f) {
-                                was_above_top = true;
-                            } else if (was_above_top && bottom < TOP_Y && ctx.vertical_vel < 0.0f) {
-                                was_above_top = false;
-                                if (audio_ok && sfx_falling) {
-                                    al_play_sample(sfx_falling, 1.0f, 0.0f, 1.0f, ALLEGRO_PLAYMODE_ONCE, NULL);
-                                }
-                            }
-
-                            if (bottom < FALL_DEATH_Y && !fell_out) {
-                                save_jump_available = false;
-                                ctx.state = STATE_PARTY_END;
-                                ctx.party_result = PARTY_FAILED;
-                                fell_out = true;
-
-                                if (!game_over_played && audio_ok && sfx_game_over) {
-                                    if (current_sample_instance) {
-                                        al_stop_sample_instance(current_sample_instance);
-                                        al_destroy_sample_instance(current_sample_instance);
-                                        current_sample_instance = NULL;
-                                    }
-                                    if (current_sample) {
-                                        al_destroy_sample(current_sample);
-                                        current_sample = NULL;
-                                    }
-                                    al_play_sample(sfx_game_over, 1.0f, 0.0f, 1.0f, ALLEGRO_PLAYMODE_ONCE, NULL);
-                                    game_over_played = true;
-                                }
-                            }
-                        }
-
-                        /* Goal check */
-                        if (ctx.gravity_enabled && ctx.on_ground && ctx.state == STATE_PLAY) {
-                            int gx, gy;
-                            world_to_grid(&ctx.vf, ctx.cam.position.x, ctx.cam.position.z, &gx, &gy);
-                            if (gx >= 0 && gx < ctx.vf.gw && gy >= 0 && gy < ctx.vf.gh) {
-                                int idx = gy * ctx.vf.gw + gx;
-                                if (ctx.vf.is_goal[idx]) {
-                                    ctx.state = STATE_PARTY_END;
-                                    if (!time_over && !fell_out) {
-                                        ctx.party_result = PARTY_SUCCESS;
-                                    }
-
-                                    if (!winning_music_started && audio_ok && music_win) {
-                                        if (current_sample_instance) {
-                                            al_stop_sample_instance(current_sample_instance);
-                                            al_destroy_sample_instance(current_sample_instance);
-                                            current_sample_instance = NULL;
-                                        }
-                                        if (current_sample) {
-                                            al_destroy_sample(current_sample);
-                                            current_sample = NULL;
-                                        }
-                                        music_win_instance = al_create_sample_instance(music_win);
-                                        if (music_win_instance) {
-                                            al_set_sample_instance_playmode(music_win_instance, ALLEGRO_PLAYMODE_ONCE);
-                                            al_attach_sample_instance_to_mixer(music_win_instance, al_get_default_mixer());
-                                            al_play_sample_instance(music_win_instance);
-                                        }
-                                        winning_music_started = true;
-                                    }
-
-                                    if (ctx.level_index != level_count - 1) {
-                                        ctx.state = STATE_LEVEL_END;
-                                    }
-
-                                    if (!score_counted) {
-                                        ctx.total_score += ctx.score;
-                                        score_counted = true;
-                                    }
-                                }
-                            }
+                        music_win_instance = al_create_sample_instance(music_win);
+                        if (music_win_instance) {
+                            al_set_sample_instance_playmode(music_win_instance, ALLEGRO_PLAYMODE_ONCE);
+                            al_attach_sample_instance_to_mixer(music_win_instance, al_get_default_mixer());
+                            al_play_sample_instance(music_win_instance);
                         }
+                        winning_music_started = true;
                     }
-                }
-
-                /* Update projectiles */
-                update_projectiles(&ctx, dt, sfx_hit_level, sfx_hit_bonus, audio_ok,
-                                   &level_boxes_hit, &level_time_bonus_boxes, &level_speed_bonus_boxes,
-                                   speed_bonus_increment, speed_max_limit);
-
-                /* Update moving pink lights */
-                update_pink_lights(&ctx, dt);
 
-                /* Celebration particles */
-                if (ctx.state == STATE_PARTY_END && ctx.party_result == PARTY_SUCCESS) {
-                    spawn_celebration_particles(&ctx);
+                    logic_accumulator -= logic_dt;
+                    profiler_count(&profiler, PROF_COUNTER_TICKS, 1);
                 }
 
-                /* Update particles */
-                if ((ctx.state == STATE_PLAY && !ctx.paused) ||
-                    ctx.state == STATE_LEVEL_END ||
-                    (ctx.state == STATE_PARTY_END && ctx.party_result == PARTY_SUCCESS)) {
-                    update_particles(&ctx, gravity, dt);
-                }
+                /* how far the clock is into the next tick, to draw between the last two */
+                render_alpha = (float)(logic_accumulator / logic_dt);
+                if (render_alpha > 1.0f) render_alpha = 1.0f;
 
+                profiler_mark(&profiler, PROF_LOGIC);
                 do_logic = 0;
             }
 
@@ -1121,22 +939,31 @@ If the browser refuses, the click callback will acquire it on next click.
                 al_clear_depth_buffer(1.0f);
                 al_clear_to_color(al_map_rgb(5, 5, 15));
 
-                Vec3 forward3 = camera_forward(&ctx.cam);
-                Vec3 target = v_add(ctx.cam.position, forward3);
+                /* camera between the last two ticks */
+                Camera view_cam = ctx.cam;
+                view_cam.position = v_lerp(ctx.cam_prev_pos, ctx.cam.position, render_alpha);
+
+                Vec3 forward3 = camera_forward(&view_cam);
+                Vec3 target = v_add(view_cam.position, forward3);
 
                 ALLEGRO_TRANSFORM view;
                 al_build_camera_transform(&view,
-                                          ctx.cam.position.x, ctx.cam.position.y, ctx.cam.position.z,
+                                          view_cam.position.x, view_cam.position.y, view_cam.position.z,
                                           target.x, target.y, target.z,
                                           0.0f, 1.0f, 0.0f);
                 al_use_transform(&view);
 
-                /* Stars */
-                render_starfield(&ctx.stars, &ctx.va_stars, light_phase);
-                vbo_draw(&ctx.g_ttfe_stream_vbo, &ctx.va_stars, ALLEGRO_PRIM_TRIANGLE_LIST);
+                Frustum frustum;
+                frustum_from_camera(&frustum, &view_cam, ctx.dh > 0 ? (float)ctx.dw / (float)ctx.dh : 1.0f, Z_NEAR, Z_FAR);
+
+                /* Stars, the frame setup above is counted with them */
+                starfield_mesh_draw(&ctx.starfield, &ctx.g_ttfe_stream_vbo, light_phase);
+                profiler_mark(&profiler, PROF_STARFIELD);
 
                 /* Level geometry */
-                vbo_draw(&ctx.g_ttfe_stream_vbo, &ctx.va_level, ALLEGRO_PRIM_TRIANGLE_LIST);
+                int visible_chunks = level_chunks_draw(&ctx.chunks_level, &frustum, &ctx.vbo_level, &ctx.va_level, NULL, ALLEGRO_PRIM_TRIANGLE_LIST);
+                profiler_count(&profiler, PROF_COUNTER_CHUNKS, visible_chunks);
+                profiler_mark(&profiler, PROF_LEVEL);
 
                 /* Glow overlay */
                 if (overlay_letters || overlay_goals) {
@@ -1145,21 +972,10 @@ If the browser refuses, the click callback will acquire it on next click.
                     int prev_depth_test = al_get_render_state(ALLEGRO_DEPTH_TEST);
                     al_set_render_state(ALLEGRO_DEPTH_TEST, 0);
 
-                    if (overlay_letters && ctx.va_overlay_letters.count > 0) {
-                        float s = sinf(light_phase * 4.0f) * 0.5f + 0.5f;
-                        float pulse_alpha = 0.6f * s + 0.2f;
-                        ALLEGRO_COLOR letter_glow = al_map_rgba_f(0.4f, 0.1f, 0.4f, pulse_alpha);
-                        for (int i = 0; i < ctx.va_overlay_letters.count; ++i) {
-                            ctx.va_overlay_letters.v[i].color = letter_glow;
-                        }
-                    }
-
-                    if (overlay_goals && ctx.va_overlay_goals.count > 0) {
-                        ALLEGRO_COLOR goal_glow = rainbow_color(light_phase * 2.0f, 1.0f);
-                        for (int i = 0; i < ctx.va_overlay_goals.count; ++i) {
-                            ctx.va_overlay_goals.v[i].color = goal_glow;
-                        }
-                    }
+                    float s = sinf(light_phase * 4.0f) * 0.5f + 0.5f;
+                    float pulse_alpha = 0.6f * s + 0.2f;
+                    ALLEGRO_COLOR letter_glow = al_map_rgba_f(0.4f, 0.1f, 0.4f, pulse_alpha);
+                    ALLEGRO_COLOR goal_glow = rainbow_color(light_phase * 2.0f, 1.0f);
 
                     if (BLEND_TEXT) {
                         al_set_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_ONE);
@@ -1167,33 +983,45 @@ If the browser refuses, the click callback will acquire it on next click.
                         al_set_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA);
                     }
 
-                    if (overlay_goals) vbo_draw(&ctx.g_ttfe_stream_vbo, &ctx.va_overlay_goals, ALLEGRO_PRIM_TRIANGLE_LIST);
-                    if (overlay_letters) vbo_draw(&ctx.g_ttfe_stream_vbo, &ctx.va_overlay_letters, ALLEGRO_PRIM_TRIANGLE_LIST);
+                    ALLEGRO_BITMAP* tint_texture = NULL;
+                    if (overlay_goals && ttfe_tint_begin(&ctx.glow_tint, goal_glow, &tint_texture)) {
+                        level_chunks_draw(&ctx.chunks_overlay_goals, &frustum, &ctx.vbo_overlay_goals, &ctx.va_overlay_goals, tint_texture, ALLEGRO_PRIM_TRIANGLE_LIST);
+                        ttfe_tint_end(&ctx.glow_tint);
+                    }
+                    if (overlay_letters && ttfe_tint_begin(&ctx.glow_tint, letter_glow, &tint_texture)) {
+                        level_chunks_draw(&ctx.chunks_overlay_letters, &frustum, &ctx.vbo_overlay_letters, &ctx.va_overlay_letters, tint_texture, ALLEGRO_PRIM_TRIANGLE_LIST);
+                        ttfe_tint_end(&ctx.glow_tint);
+                    }
 
                     al_set_render_state(ALLEGRO_DEPTH_TEST, prev_depth_test);
                     al_restore_state(ctx.render_state);
                 }
+                profiler_mark(&profiler, PROF_OVERLAY);
 
                 /* Pink lights */
-                Vec3 cam_right = camera_right(&ctx.cam);
-                Vec3 cam_up = camera_up(&ctx.cam);
+                Vec3 cam_right = camera_right(&view_cam);
+                Vec3 cam_up = camera_up(&view_cam);
 
                 if (pool_active_count(&ctx.pink_lights) > 0) {
-                    render_pink_lights(&ctx.pink_lights, &ctx.va_pink_lights, cam_right, cam_up, light_phase);
+                    render_pink_lights(&ctx.pink_lights, &ctx.va_pink_lights, &frustum, cam_right, cam_up, light_phase, render_alpha);
                     al_store_state(ctx.render_state, ALLEGRO_STATE_BLENDER);
                     al_set_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_ONE);
                     vbo_draw(&ctx.g_ttfe_stream_vbo, &ctx.va_pink_lights, ALLEGRO_PRIM_TRIANGLE_LIST);
                     al_restore_state(ctx.render_state);
                 }
+                profiler_mark(&profiler, PROF_PINK_LIGHTS);
 
                 /* Boxes */
-                render_boxes(&ctx);
+                render_boxes(&ctx, &frustum, render_alpha);
+                profiler_mark(&profiler, PROF_BOXES);
 
                 /* Particles */
-                render_particles(&ctx, cam_right, cam_up);
+                render_particles(&ctx, &frustum, cam_right, cam_up, render_alpha, sim.particles_moved ? logic_dt : 0.0f);
+                profiler_mark(&profiler, PROF_PARTICLES);
 
                 /* Projectiles */
-                render_projectiles(&ctx);
+                render_projectiles(&ctx, &view_cam, render_alpha);
+                profiler_mark(&profiler, PROF_PROJECTILES);
 
                 /*  HUD  */
                 al_set_render_state(ALLEGRO_DEPTH_TEST, 0);
@@ -1242,7 +1070,7 @@ If the browser refuses, the click callback will acquire it on next click.
                     al_draw_text(gui_font, al_map_rgb(255, 255, 255), ctx.dw / 2, ctx.dh / 2 + 40,
                                  ALLEGRO_ALIGN_CENTRE, "Press ENTER for next level or ESC to quit");
                 } else if (ctx.state == STATE_PARTY_END) {
-                    if (ctx.party_result == PARTY_SUCCESS && !time_over && !fell_out) {
+                    if (ctx.party_result == PARTY_SUCCESS && !sim.time_over && !sim.fell_out) {
                         snprintf(buf, sizeof(buf), "YOU WIN! Final score: %d", ctx.total_score);
                         al_draw_text(gui_font, al_map_rgb(0, 255, 0), ctx.dw / 2, ctx.dh / 2 - 80,
                                      ALLEGRO_ALIGN_CENTRE, buf);
@@ -1253,9 +1081,9 @@ If the browser refuses, the click callback will acquire it on next click.
                         al_draw_text(gui_font, al_map_rgb(255, 255, 255), ctx.dw / 2, ctx.dh / 2 + 40,
                                      ALLEGRO_ALIGN_CENTRE, "Press ENTER to go to score or ESC to quit");
                     } else {
-                        if (time_over) {
+                        if (sim.time_over) {
                             snprintf(buf, sizeof(buf), "YOU LOSE! Time over!");
-                        } else if (fell_out) {
+                        } else if (sim.fell_out) {
                             snprintf(buf, sizeof(buf), "YOU LOSE! You fell into the void!");
                         } else {
                             snprintf(buf, sizeof(buf), "YOU LOSE!");
@@ -1266,8 +1094,16 @@ If the browser refuses, the click callback will acquire it on next click.
                                      ALLEGRO_ALIGN_CENTRE, "Press ENTER to restart or ESC to quit");
                     }
                 }
+                profiler_mark(&profiler, PROF_HUD);
+
+                /* Profiler overlay, its own cost is not measured */
+                profiler_draw(&profiler, gui_font, ctx.dw);
 
+                profiler_start(&profiler);
                 al_flip_display();
+                profiler_mark(&profiler, PROF_FLIP);
+                ttfe_vbo_ring_frame(&ctx.g_ttfe_stream_vbo);
+                profiler_frame_end(&profiler);
                 do_draw = 0;
             }
         }
@@ -1284,14 +1120,10 @@ If the browser refuses, the click callback will acquire it on next click.
         }
 
         /* Free level resources */
-        if (ctx.vf.solid) {
-            free(ctx.vf.solid);
-            ctx.vf.solid = NULL;
-        }
-        if (ctx.vf.is_goal) {
-            free(ctx.vf.is_goal);
-            ctx.vf.is_goal = NULL;
-        }
+        ttfe_vbo_destroy(&ctx.vbo_level);
+        ttfe_vbo_destroy(&ctx.vbo_overlay_letters);
+        ttfe_vbo_destroy(&ctx.vbo_overlay_goals);
+        voxel_field_free(&ctx.vf);
 
         /* Restart level if requested */
         if (ctx.state == STATE_PARTY_END && ctx.party_result == PARTY_FAILED && restart_level) {
@@ -1309,7 +1141,7 @@ If the browser refuses, the click callback will acquire it on next click.
 
     /*  OUTRO SCREEN  */
     if (ctx.party_result == PARTY_SUCCESS) {
-        pool_clear(&ctx.particles);
+        particle_pool_clear(&ctx.particles);
         ctx.total_score += ctx.score;
 
         bool in_outro = true;
@@ -1352,9 +1184,6 @@ If the browser refuses, the click callback will acquire it on next click.
                     int count = 100 + rand() % 100;
 
                     for (int pi = 0; pi < count; ++pi) {
-                        GameEntity* p = pool_alloc(&ctx.particles);
-                        if (!p) break;
-
                         Vec3 vel = v_make(frandf(-30.0f, 30.0f), frandf(50.0f, 120.0f), 0.0f);
 
                         ALLEGRO_COLOR color;
@@ -1368,26 +1197,16 @@ If the browser refuses, the click callback will acquire it on next click.
                         else
                             color = al_map_rgb(255, 215, 0);
 
-                        entity_init_particle(p,
-                                             v_make(center.x + frandf(-25.0f, 25.0f),
-                                                    center.y + frandf(-10.0f, 10.0f), 0.0f),
-                                             vel, frandf(1.0f, 4.0f), 3.0f, color);
+                        if (!particle_pool_spawn(&ctx.particles,
+                                                 v_make(center.x + frandf(-25.0f, 25.0f),
+                                                        center.y + frandf(-10.0f, 10.0f), 0.0f),
+                                                 vel, frandf(1.0f, 4.0f), 2.0f, color))
+                            break;
                     }
                 }
 
-                /* Update confetti (2D) */
-                for (int i = 0; i < ctx.particles.capacity; ++i) {
-                    GameEntity* p = &ctx.particles.entities[i];
-                    if (!entity_is_active(p)) continue;
-
-                    p->pos.x += p->vel.x * dt;
-                    p->pos.y += p->vel.y * dt;
-                    p->lifetime -= dt;
-
-                    if (p->lifetime <= 0.0f || p->pos.y > (float)ctx.dh + 50.0f) {
-                        entity_deactivate(p);
-                    }
-                }
+                /* Update confetti (2D: z and gravity stay 0) */
+                particle_pool_update(&ctx.particles, dt, 0.0f, (float)ctx.dh + 50.0f);
 
                 if (ctx.mouse_locked) {
                     ctx.mouse_locked = false;
@@ -1401,17 +1220,8 @@ If the browser refuses, the click callback will acquire it on next click.
                 al_set_render_state(ALLEGRO_DEPTH_TEST, 0);
                 al_clear_to_color(al_map_rgb(0, 0, 0));
 
-                /* Draw confetti as points */
-                ALLEGRO_VERTEX pv[MAX_PARTICLES];
-                int pc = 0;
-                for (int i = 0; i < ctx.particles.capacity; ++i) {
-                    GameEntity* p = &ctx.particles.entities[i];
-                    if (!entity_is_active(p)) continue;
-                    pv[pc++] = (ALLEGRO_VERTEX){p->pos.x, p->pos.y, 0.0f, 0.0f, 0.0f, p->color};
-                }
-                if (pc > 0) {
-                    al_draw_prim(pv, NULL, NULL, 0, pc, ALLEGRO_PRIM_POINT_LIST);
-                }
+                /* Draw confetti */
+                render_confetti(&ctx);
 
                 char buf[256];
                 snprintf(buf, sizeof(buf), "CONGRATULATIONS! Final score: %d", ctx.total_score);
@@ -1429,6 +1239,7 @@ If the browser refuses, the click callback will acquire it on next click.
                              ALLEGRO_ALIGN_CENTRE, "Press ENTER or ESC to quit");
 
                 al_flip_display();
+                ttfe_vbo_ring_frame(&ctx.g_ttfe_stream_vbo);
                 do_draw = 0;
             }
         }
@@ -1436,18 +1247,11 @@ If the browser refuses, the click callback will acquire it on next click.
 
 cleanup:
     /* Cleanup */
-    for (int i = 0; i < level_count; ++i) free(levels[i]);
-    free(levels);
+    level_prefetch_free(&prefetch);
 
-    if (songs) {
-        for (int i = 0; i < songs_count; ++i) free(songs[i]);
-        free(songs);
-    }
-
-    if (intro_lines) {
-        for (int i = 0; i < intro_count; ++i) free(intro_lines[i]);
-        free(intro_lines);
-    }
+    text_file_close(&levels_text);
+    text_file_close(&songs_text);
+    text_file_close(&intro_text);
 
     if (audio_ok) {
         if (music_intro_instance) al_destroy_sample_instance(music_intro_instance);
@@ -1463,7 +1267,14 @@ cleanup:
         al_uninstall_audio();
     }
 
+    n_log(LOG_INFO, "stream ring high water: %d/%d vertices, %d/%d indices per frame",
+          ctx.g_ttfe_stream_vbo.vertex_ring.high_water, ctx.g_ttfe_stream_vbo.capacity,
+          ctx.g_ttfe_stream_vbo.index_ring.high_water, ctx.g_ttfe_stream_vbo.index_capacity);
     ttfe_vbo_destroy(&ctx.g_ttfe_stream_vbo);
+    ttfe_vbo_destroy(&ctx.vbo_level);
+    ttfe_vbo_destroy(&ctx.vbo_overlay_letters);
+    ttfe_vbo_destroy(&ctx.vbo_overlay_goals);
+    ttfe_tint_destroy(&ctx.glow_tint);
 
     game_context_free(&ctx);
 
@@ -1474,9 +1285,7 @@ cleanup:
     al_destroy_event_queue(queue);
     al_destroy_display(display);
 
-    FreeNoLog(level_font_file);
-    FreeNoLog(gui_font_file);
-    FreeNoLog(levels_file);
+    app_config_free(&config);
 
     return 0;
 }
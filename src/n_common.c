@@ -42,6 +42,7 @@ void n_abort(char const* format, ...) {
 
     vsnprintf(str, sizeof str, format, args);
     va_end(args);
+    n_log_flush();
     fprintf(stderr, "%s", str);
     exit(1);
 }
@@ -53,6 +53,47 @@ static FILE* log_file = NULL;
 /*! static proc name, for windows event log */
 char* proc_name = NULL;
 
+/*! internal struct for one pre-formatted asynchronous log line */
+typedef struct LOG_RECORD {
+    /*! length of text */
+    int length;
+    /*! header, message and end of line */
+    char text[LOG_ASYNC_RECORD_SIZE];
+} LOG_RECORD;
+
+/*! internal single producer / single consumer ring of a logging thread */
+typedef struct LOG_RING {
+    /*! the records */
+    LOG_RECORD records[LOG_ASYNC_RING_RECORDS];
+    /*! next record to write, only moved by the owner thread */
+    size_t head;
+    /*! next record to read, only moved by the writer */
+    size_t tail;
+    /*! 1 while a thread owns the ring */
+    int owned;
+} LOG_RING;
+
+/*! rings of the logging threads, allocated on their first asynchronous log and never freed */
+static LOG_RING* log_rings[LOG_ASYNC_MAX_THREADS];
+/*! asynchronous logging enabled */
+static int log_async = 0;
+/*! records lost on full rings */
+static size_t log_dropped = 0;
+/*! log_dropped value at the last drop report, writer side */
+static size_t log_dropped_reported = 0;
+/*! writer thread */
+static pthread_t log_writer;
+/*! writer thread keeps running while set */
+static int log_writer_running = 0;
+/*! serialize the ring readers: writer thread and n_log_flush */
+static pthread_mutex_t log_drain_mutex = PTHREAD_MUTEX_INITIALIZER;
+/*! ring of the calling thread */
+static pthread_key_t log_ring_key;
+/*! log_ring_key creation */
+static pthread_once_t log_ring_key_once = PTHREAD_ONCE_INIT;
+/*! atexit handler registered */
+static int log_atexit_set = 0;
+
 /*!\fn open_sysjrnl( char *identity )
  *\brief Open connection to syslog or create internals for event log
  *\param identity Tag for syslog or NULL to use argv[0]
@@ -156,6 +197,201 @@ FILE* get_log_file(void) {
     return log_file;
 } /*get_log_level() */
 
+/*!\fn static void log_ring_release( void *ring )
+ *\brief thread exit destructor: the ring can be owned by another thread, its pending records are kept
+ *\param ring the LOG_RING of the exiting thread
+ */
+static void log_ring_release(void* ring) {
+    __atomic_store_n(&((LOG_RING*)ring)->owned, 0, __ATOMIC_RELEASE);
+} /* log_ring_release */
+
+/*!\fn static void log_ring_key_create( void )
+ *\brief create the key of the thread rings, once
+ */
+static void log_ring_key_create(void) {
+    pthread_key_create(&log_ring_key, log_ring_release);
+} /* log_ring_key_create */
+
+/*!\fn static LOG_RING *log_ring_claim( int slot )
+ *\brief try to own the ring of slot, creating it if needed
+ *\param slot index in log_rings
+ *\return the owned ring or NULL if another thread has it
+ */
+static LOG_RING* log_ring_claim(int slot) {
+    LOG_RING* ring = __atomic_load_n(&log_rings[slot], __ATOMIC_ACQUIRE);
+    if (!ring) {
+        /* no Malloc here: its error path logs */
+        LOG_RING* fresh = (LOG_RING*)calloc(1, sizeof(LOG_RING));
+        if (!fresh)
+            return NULL;
+        fresh->owned = 1;
+        if (__atomic_compare_exchange_n(&log_rings[slot], &ring, fresh, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return fresh;
+        /* another thread published this slot first, ring is now its ring */
+        free(fresh);
+    }
+    int free_ring = 0;
+    if (__atomic_compare_exchange_n(&ring->owned, &free_ring, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return ring;
+    return NULL;
+} /* log_ring_claim */
+
+/*!\fn static LOG_RING *log_thread_ring( void )
+ *\brief ring of the calling thread, claimed on its first asynchronous log
+ *\return the ring or NULL if LOG_ASYNC_MAX_THREADS threads already have one
+ */
+static LOG_RING* log_thread_ring(void) {
+    LOG_RING* ring = (LOG_RING*)pthread_getspecific(log_ring_key);
+    if (ring)
+        return ring;
+    for (int slot = 0; slot < LOG_ASYNC_MAX_THREADS; slot++) {
+        if ((ring = log_ring_claim(slot))) {
+            pthread_setspecific(log_ring_key, ring);
+            return ring;
+        }
+    }
+    return NULL;
+} /* log_thread_ring */
+
+/*!\fn static void log_async_push( LOG_RING *ring , int level , const char *file , const char *func , int line , const char *format , va_list args )
+ *\brief format a log line into the next record of the calling thread ring, or count it as dropped if the ring is full
+ *\param ring ring of the calling thread
+ *\param level Logging level
+ *\param file File containing the emmited log
+ *\param func Function emmiting the log
+ *\param line Line of the log
+ *\param format Format and string of the log, printf style
+ *\param args format arguments
+ */
+static void log_async_push(LOG_RING* ring, int level, const char* file, const char* func, int line, const char* format, va_list args) {
+    size_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= LOG_ASYNC_RING_RECORDS) {
+        __atomic_fetch_add(&log_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    LOG_RECORD* rec = &ring->records[head % LOG_ASYNC_RING_RECORDS];
+    const int max_len = LOG_ASYNC_RECORD_SIZE - 2; /* room for the end of line and the end of string */
+    int len = snprintf(rec->text, LOG_ASYNC_RECORD_SIZE, "%s:%jd:%s->%s:%d ", prioritynames[level].c_name, (intmax_t)time(NULL), file, func, line);
+    if (len < 0)
+        len = 0;
+    if (len < max_len) {
+        int msg = vsnprintf(rec->text + len, (size_t)(LOG_ASYNC_RECORD_SIZE - len), format, args);
+        if (msg > 0)
+            len += msg;
+    }
+    if (len > max_len)
+        len = max_len; /* truncated */
+    rec->text[len++] = '\n';
+    rec->text[len] = '\0';
+    rec->length = len;
+
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+} /* log_async_push */
+
+/*!\fn static int log_async_drain( void )
+ *\brief write the pending records of every ring, and the number of dropped ones if it changed. Caller holds log_drain_mutex
+ *\return the number of written lines
+ */
+static int log_async_drain(void) {
+    FILE* out = log_file ? log_file : stderr;
+    int written = 0;
+
+    for (int slot = 0; slot < LOG_ASYNC_MAX_THREADS; slot++) {
+        LOG_RING* ring = __atomic_load_n(&log_rings[slot], __ATOMIC_ACQUIRE);
+        if (!ring)
+            continue;
+        size_t tail = ring->tail;
+        size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        for (; tail != head; tail++) {
+            const LOG_RECORD* rec = &ring->records[tail % LOG_ASYNC_RING_RECORDS];
+            fwrite(rec->text, 1, (size_t)rec->length, out);
+            written++;
+        }
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    size_t dropped = __atomic_load_n(&log_dropped, __ATOMIC_RELAXED);
+    if (dropped != log_dropped_reported) {
+        fprintf(out, "WARNING:%jd:n_log: %zu log records dropped, rings were full\n", (intmax_t)time(NULL), dropped - log_dropped_reported);
+        log_dropped_reported = dropped;
+        written++;
+    }
+    if (written)
+        fflush(out);
+    return written;
+} /* log_async_drain */
+
+/*!\fn static void *log_writer_thread( void *arg )
+ *\brief background writer: drain the rings, sleep LOG_ASYNC_IDLE_US when they are empty
+ *\param arg unused
+ *\return NULL
+ */
+static void* log_writer_thread(void* arg) {
+    (void)arg;
+    while (__atomic_load_n(&log_writer_running, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&log_drain_mutex);
+        int written = log_async_drain();
+        pthread_mutex_unlock(&log_drain_mutex);
+        if (!written)
+            usleep(LOG_ASYNC_IDLE_US);
+    }
+    return NULL;
+} /* log_writer_thread */
+
+/*!\fn static void log_async_atexit( void )
+ *\brief stop the writer and write the pending records at exit
+ */
+static void log_async_atexit(void) {
+    set_log_async(FALSE);
+} /* log_async_atexit */
+
+/*!\fn int set_log_async( int enabled )
+ *\brief Enable or disable asynchronous logging. When enabled, the stderr and file outputs are formatted into a ring of the calling thread and written by a background thread. Syslog stays synchronous
+ *\param enabled TRUE or FALSE
+ *\return TRUE, or FALSE if the writer thread could not be started
+ */
+int set_log_async(int enabled) {
+    pthread_once(&log_ring_key_once, log_ring_key_create);
+
+    if (enabled && !__atomic_load_n(&log_async, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&log_writer_running, 1, __ATOMIC_RELEASE);
+        if (pthread_create(&log_writer, NULL, log_writer_thread, NULL) != 0) {
+            __atomic_store_n(&log_writer_running, 0, __ATOMIC_RELEASE);
+            return FALSE;
+        }
+        if (!log_atexit_set) {
+            atexit(log_async_atexit);
+            log_atexit_set = 1;
+        }
+        __atomic_store_n(&log_async, 1, __ATOMIC_RELEASE);
+    } else if (!enabled && __atomic_load_n(&log_async, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&log_async, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&log_writer_running, 0, __ATOMIC_RELEASE);
+        pthread_join(log_writer, NULL);
+        n_log_flush();
+    }
+    return TRUE;
+} /* set_log_async */
+
+/*!\fn void n_log_flush( void )
+ *\brief Write every pending asynchronous log record and flush the log output
+ */
+void n_log_flush(void) {
+    pthread_mutex_lock(&log_drain_mutex);
+    if (!log_async_drain())
+        fflush(log_file ? log_file : stderr);
+    pthread_mutex_unlock(&log_drain_mutex);
+} /* n_log_flush */
+
+/*!\fn size_t get_log_dropped( void )
+ *\brief Number of asynchronous log records dropped because the ring of their thread was full
+ *\return the drop counter
+ */
+size_t get_log_dropped(void) {
+    return __atomic_load_n(&log_dropped, __ATOMIC_RELAXED);
+} /* get_log_dropped */
+
 #ifndef _vscprintf
 /*!\fn int _vscprintf_so(const char * format, va_list pargs)
  *\brief compute the size of a string made with format 'fmt' and arguments in the va_list 'ap', helper for vasprintf
@@ -237,6 +473,16 @@ void _n_log(int level, const char* file, const char* func, int line, const char*
 
     if (level <= log_level) {
         va_list args;
+
+        /* asynchronous: format into the thread ring, the writer thread does the output */
+        LOG_RING* ring = NULL;
+        if (LOG_TYPE != LOG_SYSJRNL && __atomic_load_n(&log_async, __ATOMIC_ACQUIRE) && (ring = log_thread_ring())) {
+            va_start(args, format);
+            log_async_push(ring, level, file, func, line, format, args);
+            va_end(args);
+            return;
+        }
+
         char* syslogbuffer = NULL;
         char* eventbuffer = NULL;
 #ifdef __windows__
@@ -65,12 +65,27 @@ extern "C" {
 
 #endif
 
+/*! compile time log level: n_log calls of a higher level are removed by the compiler */
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_DEBUG
+#endif
+
 /*! Logging function wrapper to get line and func */
-#define n_log(__LEVEL__, ...)                                         \
-    do {                                                              \
-        _n_log(__LEVEL__, __FILE__, __func__, __LINE__, __VA_ARGS__); \
+#define n_log(__LEVEL__, ...)                                             \
+    do {                                                                  \
+        if ((__LEVEL__) <= LOG_COMPILE_LEVEL)                             \
+            _n_log(__LEVEL__, __FILE__, __func__, __LINE__, __VA_ARGS__); \
     } while (0)
 
+/*! size of a pre-formatted async log record, longer lines are truncated */
+#define LOG_ASYNC_RECORD_SIZE 256
+/*! records in each thread ring, a full ring drops the new records */
+#define LOG_ASYNC_RING_RECORDS 256
+/*! threads logging at the same time with their own ring, the others write synchronously */
+#define LOG_ASYNC_MAX_THREADS 16
+/*! writer thread sleep when all rings are empty, in microseconds */
+#define LOG_ASYNC_IDLE_US 1000
+
 /*! ThreadSafe LOGging structure */
 typedef struct TS_LOG {
     /*! mutex for thread-safe writting */
@@ -95,6 +110,12 @@ int set_log_file_fd(FILE* fd);
 FILE* get_log_file(void);
 /* Full log function. Muste be wrapped in a MACRO to get the correct file-func-line informations */
 void _n_log(int level, const char* file, const char* func, int line, const char* format, ...);
+/* Enable or disable the asynchronous stderr / file logging */
+int set_log_async(int enabled);
+/* Write every pending asynchronous log record */
+void n_log_flush(void);
+/* Number of asynchronous log records dropped because a ring was full */
+size_t get_log_dropped(void);
 
 /* Open a thread-safe logging file */
 int open_safe_logging(TS_LOG** log, char* pathname, char* opt);
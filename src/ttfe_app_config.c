@@ -5,6 +5,8 @@
  *\date 08/12/2025
  */
 
+#include <string.h>
+
 #include "ttfe_app_config.h"
 #include "cJSON.h"
 #include "nilorea/n_str.h"
@@ -249,3 +251,61 @@ error_exit:
     }
     return FALSE;
 }
+
+/* replace a config string by a command line one, if any */
+static void app_config_override(char** value, const char* override) {
+    if (!override) return;
+    FreeNoLog(*value);
+    *value = strdup(override);
+}
+
+/* load state_filename into cfg, then use the font and levels files given on the command line (NULL to keep the config ones). Returns FALSE on error */
+int app_config_load(AppConfig* cfg, char* state_filename, const char* level_font_file, const char* gui_font_file, const char* levels_file) {
+    memset(cfg, 0, sizeof(AppConfig));
+    if (load_app_config(state_filename, &cfg->width, &cfg->height, &cfg->fullscreen,
+                        &cfg->intro_sample, &cfg->win_sample, &cfg->falling_sample, &cfg->shoot_sample, &cfg->jump_sample,
+                        &cfg->hit_level_sample, &cfg->hit_bonus_sample, &cfg->game_over_sample,
+                        &cfg->fps, &cfg->logic,
+                        &cfg->level_font_file, &cfg->level_font_size, &cfg->gui_font_file, &cfg->gui_font_size, &cfg->levels_file,
+                        &cfg->gravity, &cfg->jump_vel, &cfg->base_speed, &cfg->speed_bonus_increment, &cfg->speed_max_limit,
+                        &cfg->mouse_sensitivity, &cfg->bullet_speed, &cfg->bullet_delta_divider) != TRUE) {
+        n_log(LOG_ERR, "couldn't load %s!", state_filename);
+        app_config_free(cfg);
+        return FALSE;
+    }
+    app_config_override(&cfg->level_font_file, level_font_file);
+    app_config_override(&cfg->gui_font_file, gui_font_file);
+    app_config_override(&cfg->levels_file, levels_file);
+    return TRUE;
+}
+
+/* free the strings of cfg */
+void app_config_free(AppConfig* cfg) {
+    FreeNoLog(cfg->intro_sample);
+    FreeNoLog(cfg->win_sample);
+    FreeNoLog(cfg->falling_sample);
+    FreeNoLog(cfg->shoot_sample);
+    FreeNoLog(cfg->jump_sample);
+    FreeNoLog(cfg->hit_level_sample);
+    FreeNoLog(cfg->hit_bonus_sample);
+    FreeNoLog(cfg->game_over_sample);
+    FreeNoLog(cfg->level_font_file);
+    FreeNoLog(cfg->gui_font_file);
+    FreeNoLog(cfg->levels_file);
+}
+
+/* log level of a -V option (INFO, NOTICE, VERBOSE, ERROR, DEBUG), logs an error and returns -1 if unknown */
+int app_config_log_level(const char* name) {
+    if (!strncmp("INFO", name, 6))
+        return LOG_INFO;
+    if (!strncmp("NOTICE", name, 6))
+        return LOG_NOTICE;
+    if (!strncmp("VERBOSE", name, 7))
+        return LOG_NOTICE;
+    if (!strncmp("ERROR", name, 5))
+        return LOG_ERR;
+    if (!strncmp("DEBUG", name, 5))
+        return LOG_DEBUG;
+    n_log(LOG_ERR, "%s is not a valid log level", name);
+    return -1;
+}
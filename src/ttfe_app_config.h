@@ -15,7 +15,43 @@ extern "C" {
 #include <stdbool.h>
 #include <stddef.h>
 
+/* app_config.json settings, the strings are freed by app_config_free */
+typedef struct {
+    long int width;
+    long int height;
+    bool fullscreen;
+    char* intro_sample;
+    char* win_sample;
+    char* falling_sample;
+    char* shoot_sample;
+    char* jump_sample;
+    char* hit_level_sample;
+    char* hit_bonus_sample;
+    char* game_over_sample;
+    double fps;
+    double logic;
+    char* level_font_file;
+    int level_font_size;
+    char* gui_font_file;
+    int gui_font_size;
+    char* levels_file;
+    float gravity;
+    float jump_vel;
+    float base_speed;
+    float speed_bonus_increment;
+    float speed_max_limit;
+    float mouse_sensitivity;
+    float bullet_speed;
+    int bullet_delta_divider;
+} AppConfig;
+
 int load_app_config(char* state_filename, long int* WIDTH, long int* HEIGHT, bool* fullscreen, char** intro_sample, char** win_sample, char** falling_sample, char** shoot_sample, char** jump_sample, char** hit_level_sample, char** hit_bonus_sample, char** game_over_sample, double* fps, double* logic, char** level_font_file, int* level_font_size, char** gui_font_file, int* gui_font_size, char** levels_file, float* gravity, float* jump_vel, float* config_base_speed, float* SPEED_BONUS_INCREMENT, float* SPEED_MAX_LIMIT, float* mouse_sensitivity, float* bullet_speed, int* bullet_delta_divider);
+/* load state_filename into cfg, then use the font and levels files given on the command line (NULL to keep the config ones). Returns FALSE on error */
+int app_config_load(AppConfig* cfg, char* state_filename, const char* level_font_file, const char* gui_font_file, const char* levels_file);
+/* free the strings of cfg */
+void app_config_free(AppConfig* cfg);
+/* log level of a -V option (INFO, NOTICE, VERBOSE, ERROR, DEBUG), logs an error and returns -1 if unknown */
+int app_config_log_level(const char* name);
 
 #ifdef __cplusplus
 }
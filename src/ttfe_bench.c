@@ -0,0 +1,228 @@
+/**\file ttfe_bench.c
+ *  headless simulation bench: builds the levels and runs the logic tick with scripted input, no display needed
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+#include <allegro5/allegro_ttf.h>
+
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+#include "nilorea/n_str.h"
+#include "ttfe_app_config.h"
+#include "ttfe_game_context.h"
+#include "ttfe_particles.h"
+#include "ttfe_level.h"
+#include "ttfe_text.h"
+#include "ttfe_sim.h"
+
+/* scripted input periods, in ticks */
+#define BENCH_FIRE_PERIOD 10
+#define BENCH_JUMP_PERIOD 90
+#define BENCH_STRAFE_PERIOD 240
+
+int getoptret = 0;
+int log_level = LOG_ERR;
+
+void usage(int log_level, char* progname) {
+    n_log(log_level,
+          "\n    %s usage:\n"
+          "    -h => print help\n"
+          "    -V LOGLEVEL => choose log level\n"
+          "    -n ticks => logic ticks per level (default 6000)\n"
+          "    -s seed => random seed (default 1)\n"
+          "    -f level_font_file\n"
+          "    -l levels_file\n",
+          progname);
+}
+
+/* put the player back at the start of the current level */
+static void bench_restart_level(GameContext* ctx, SimState* sim, float base_speed) {
+    game_context_reset_level(ctx);
+    ctx->party_result = PARTY_UNDECIDED;
+    ctx->move_speed = base_speed;
+    place_boxes_and_lights(ctx);
+    setup_camera_start(ctx);
+    sim_level_start(sim);
+}
+
+int main(int argc, char** argv) {
+    set_log_level(LOG_ERR);
+
+    long int ticks = 6000;
+    unsigned int seed = 1;
+    const char* override_level_font_file = NULL;
+    const char* override_levels_file = NULL;
+
+    while ((getoptret = getopt(argc, argv, "hV:n:s:f:l:")) != EOF) {
+        switch (getoptret) {
+            case 'h':
+                usage(LOG_INFO, argv[0]);
+                exit(0);
+            case 'V':
+                if ((log_level = app_config_log_level(optarg)) < 0)
+                    exit(FALSE);
+                set_log_level(log_level);
+                break;
+            case 'n':
+                ticks = strtol(optarg, NULL, 10);
+                if (ticks <= 0) {
+                    n_log(LOG_ERR, "%s is not a valid tick count", optarg);
+                    exit(FALSE);
+                }
+                break;
+            case 's':
+                seed = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'f':
+                override_level_font_file = optarg;
+                break;
+            case 'l':
+                override_levels_file = optarg;
+                break;
+            default:
+                usage(LOG_ERR, argv[0]);
+                exit(FALSE);
+        }
+    }
+
+    /* same config as the game, display and audio settings are ignored */
+    AppConfig config;
+    if (app_config_load(&config, "DATA/app_config.json", override_level_font_file, NULL, override_levels_file) != TRUE) {
+        exit(1);
+    }
+
+    /* no display: fonts and the text bitmaps are memory bitmaps */
+    if (!al_init()) {
+        fprintf(stderr, "al_init() failed\n");
+        return FALSE;
+    }
+    al_init_font_addon();
+    al_init_ttf_addon();
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP);
+
+    TextFile levels_text;
+    if (!text_file_open(&levels_text, config.levels_file)) {
+        return FALSE;
+    }
+    int level_count = levels_text.line_count;
+
+    ALLEGRO_FONT* level_font = al_load_ttf_font(config.level_font_file, config.level_font_size, 0);
+    if (!level_font) {
+        n_log(LOG_ERR, "Failed to load level font %s", config.level_font_file);
+        return FALSE;
+    }
+
+    srand(seed);
+
+    GameContext ctx;
+    game_context_init(&ctx, config.base_speed);
+    ctx.dw = (int)config.width;
+    ctx.dh = (int)config.height;
+    ctx.level_count = level_count;
+
+    SimParams sim_params = {config.gravity, config.speed_bonus_increment, config.speed_max_limit, SIM_OBSTACLE_SPAWN_DELAY};
+    SimState sim;
+    memset(&sim, 0, sizeof(SimState));
+
+    const float dt = (float)(1.0 / config.logic);
+    double total_time = 0.0;
+    long int total_ticks = 0;
+    double total_phase[SIM_PHASE_COUNT] = {0};
+
+    printf("ttfe_bench: %d levels, %ld ticks per level at %.0f Hz, seed %u, particle kernel %s\n",
+           level_count, ticks, config.logic, seed, particle_pool_kernel_name());
+
+    for (ctx.level_index = 0; ctx.level_index < level_count; ++ctx.level_index) {
+        TextSpan level_tokens[LEVEL_LINE_TOKENS];
+        if (text_span_tokens(levels_text.lines[ctx.level_index], level_tokens, LEVEL_LINE_TOKENS) < 1) {
+            n_log(LOG_ERR, "error splitting level line %d", ctx.level_index + 1);
+            continue;
+        }
+        const char* phrase = level_tokens[0].ptr;
+
+        /* Build level */
+        double build_start = al_get_time();
+        if (!build_level_voxels(&ctx.vf, level_font, NULL, phrase, (int)level_tokens[0].len, config.level_font_size) ||
+            !build_level_meshes(&ctx.vf, &ctx.va_level, &ctx.va_overlay_letters, &ctx.va_overlay_goals, NULL) ||
+            !box_grid_setup(&ctx.box_grid, &ctx.vf)) {
+            n_log(LOG_ERR, "unable to build level %d: %s", ctx.level_index + 1, phrase);
+            voxel_field_free(&ctx.vf);
+            continue;
+        }
+        voxel_field_build_distance(&ctx.vf);
+        double build_time = al_get_time() - build_start;
+
+        bench_restart_level(&ctx, &sim, config.base_speed);
+
+        /* Scripted run: walk forward, strafe both ways, sweep the view, fire and jump */
+        double phase[SIM_PHASE_COUNT] = {0};
+        int restarts = 0;
+        int max_projectiles = 0, max_particles = 0, max_boxes = 0;
+        double start = al_get_time();
+        for (long int tick = 0; tick < ticks; tick++) {
+            SimInput input = {true, false, false, false, false};
+            if ((tick / BENCH_STRAFE_PERIOD) % 2)
+                input.left = true;
+            else
+                input.right = true;
+            ctx.cam.yaw += 0.004f * sinf((float)tick * 0.01f);
+
+            if (tick % BENCH_FIRE_PERIOD == 0)
+                fire_projectile(&ctx, NULL, false, config.bullet_speed);
+            if (tick % BENCH_JUMP_PERIOD == 0)
+                sim_jump(&ctx, &sim, config.jump_vel);
+
+            sim_tick(&ctx, &sim, &sim_params, &input, dt, NULL, NULL, false, phase);
+
+            if (ctx.projectiles.count > max_projectiles) max_projectiles = ctx.projectiles.count;
+            if (ctx.particles.count > max_particles) max_particles = ctx.particles.count;
+            if (ctx.boxes.count > max_boxes) max_boxes = ctx.boxes.count;
+
+            /* lost, won or timed out: start over */
+            if (ctx.state != STATE_PLAY) {
+                bench_restart_level(&ctx, &sim, config.base_speed);
+                restarts++;
+            }
+        }
+        double elapsed = al_get_time() - start;
+
+        printf("level %d \"%s\": %dx%d cells, build %.2f ms, %.0f ticks/s, %.2f us/tick, %d restarts, max %d boxes %d projectiles %d particles\n",
+               ctx.level_index + 1, phrase, ctx.vf.gw, ctx.vf.gh, build_time * 1000.0,
+               elapsed > 0.0 ? (double)ticks / elapsed : 0.0, elapsed * 1e6 / (double)ticks,
+               restarts, max_boxes, max_projectiles, max_particles);
+        for (int p = 0; p < SIM_PHASE_COUNT; p++) {
+            printf("    %-12s %8.2f us/tick\n", sim_phase_name(p), phase[p] * 1e6 / (double)ticks);
+            total_phase[p] += phase[p];
+        }
+        total_time += elapsed;
+        total_ticks += ticks;
+
+        voxel_field_free(&ctx.vf);
+    }
+
+    if (total_ticks > 0) {
+        printf("total: %ld ticks, %.0f ticks/s, %.2f us/tick\n", total_ticks,
+               total_time > 0.0 ? (double)total_ticks / total_time : 0.0, total_time * 1e6 / (double)total_ticks);
+        for (int p = 0; p < SIM_PHASE_COUNT; p++) {
+            printf("    %-12s %8.2f us/tick\n", sim_phase_name(p), total_phase[p] * 1e6 / (double)total_ticks);
+        }
+    }
+
+    game_context_free(&ctx);
+    al_destroy_font(level_font);
+    text_file_close(&levels_text);
+
+    app_config_free(&config);
+
+    return total_ticks > 0 ? 0 : 1;
+}
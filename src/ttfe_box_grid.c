@@ -0,0 +1,120 @@
+/**\file ttfe_box_grid.c
+ *  uniform grid over the box AABBs, for projectile vs box tests
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "ttfe_box_grid.h"
+
+/* bucket coordinate of a world position, clamped to [0, n) */
+static int bucket_coord(float v, float origin, float bucket_size, int n) {
+    int b = (int)floorf((v - origin) / bucket_size);
+    return b < 0 ? 0 : (b >= n ? n - 1 : b);
+}
+
+/* size the grid for a level voxel field */
+bool box_grid_setup(BoxGrid* grid, const VoxelField* vf) {
+    int bw = (vf->gw + BOX_GRID_CELLS - 1) / BOX_GRID_CELLS;
+    int bh = (vf->gh + BOX_GRID_CELLS - 1) / BOX_GRID_CELLS;
+    if (bw < 1) bw = 1;
+    if (bh < 1) bh = 1;
+
+    if (!grid->bucket_start || bw * bh > grid->bw * grid->bh) {
+        /* one block: bucket_start then cursor */
+        int* block = (int*)realloc(grid->bucket_start, sizeof(int) * (size_t)(bw * bh * 2 + 1));
+        if (!block) return false;
+        grid->bucket_start = block;
+    }
+    grid->bw = bw;
+    grid->bh = bh;
+    grid->cursor = grid->bucket_start + bw * bh + 1;
+    grid->bucket_size = vf->cell_size * (float)BOX_GRID_CELLS;
+    grid->origin_x = vf->origin_x;
+    grid->origin_z = vf->origin_z;
+    memset(grid->bucket_start, 0, sizeof(int) * (size_t)(bw * bh + 1));
+    return true;
+}
+
+/* free the grid */
+void box_grid_free(BoxGrid* grid) {
+    free(grid->bucket_start);
+    free(grid->items);
+    memset(grid, 0, sizeof(BoxGrid));
+}
+
+/* list the active boxes of pool in the buckets they overlap */
+bool box_grid_rebuild(BoxGrid* grid, const EntityPool* boxes) {
+    if (!grid->bucket_start) return false;
+
+    int nb = grid->bw * grid->bh;
+    int* start = grid->bucket_start;
+    memset(start, 0, sizeof(int) * (size_t)(nb + 1));
+
+    /* count, shifted by one for the prefix sum */
+    int total = 0;
+    for (int k = 0; k < boxes->count; k++) {
+        const GameEntity* box = &boxes->entities[boxes->active[k]];
+        int x0 = bucket_coord(box->pos.x - box->size, grid->origin_x, grid->bucket_size, grid->bw);
+        int x1 = bucket_coord(box->pos.x + box->size, grid->origin_x, grid->bucket_size, grid->bw);
+        int z0 = bucket_coord(box->pos.z - box->size, grid->origin_z, grid->bucket_size, grid->bh);
+        int z1 = bucket_coord(box->pos.z + box->size, grid->origin_z, grid->bucket_size, grid->bh);
+        for (int bz = z0; bz <= z1; bz++)
+            for (int bx = x0; bx <= x1; bx++)
+                start[bz * grid->bw + bx + 1]++;
+        total += (x1 - x0 + 1) * (z1 - z0 + 1);
+    }
+
+    if (total > grid->item_capacity) {
+        int cap = grid->item_capacity ? grid->item_capacity : 64;
+        while (cap < total) cap *= 2;
+        int* items = (int*)realloc(grid->items, sizeof(int) * (size_t)cap);
+        if (!items) {
+            memset(start, 0, sizeof(int) * (size_t)(nb + 1));
+            return false;
+        }
+        grid->items = items;
+        grid->item_capacity = cap;
+    }
+
+    for (int b = 0; b < nb; b++) {
+        start[b + 1] += start[b];
+        grid->cursor[b] = start[b];
+    }
+
+    /* fill */
+    for (int k = 0; k < boxes->count; k++) {
+        int e = boxes->active[k];
+        const GameEntity* box = &boxes->entities[e];
+        int x0 = bucket_coord(box->pos.x - box->size, grid->origin_x, grid->bucket_size, grid->bw);
+        int x1 = bucket_coord(box->pos.x + box->size, grid->origin_x, grid->bucket_size, grid->bw);
+        int z0 = bucket_coord(box->pos.z - box->size, grid->origin_z, grid->bucket_size, grid->bh);
+        int z1 = bucket_coord(box->pos.z + box->size, grid->origin_z, grid->bucket_size, grid->bh);
+        for (int bz = z0; bz <= z1; bz++)
+            for (int bx = x0; bx <= x1; bx++)
+                grid->items[grid->cursor[bz * grid->bw + bx]++] = e;
+    }
+    return true;
+}
+
+/* boxes listed in bucket (bx, bz): sets *items to their pool indices and returns their count. Released boxes stay listed until the next rebuild */
+int box_grid_bucket(const BoxGrid* grid, int bx, int bz, const int** items) {
+    if (!grid->items) {
+        *items = NULL;
+        return 0;
+    }
+    int b = bz * grid->bw + bx;
+    *items = grid->items + grid->bucket_start[b];
+    return grid->bucket_start[b + 1] - grid->bucket_start[b];
+}
+
+/* bucket range [bx0, bx1] x [bz0, bz1] overlapped by an xz rectangle */
+void box_grid_range(const BoxGrid* grid, float min_x, float min_z, float max_x, float max_z, int* bx0, int* bz0, int* bx1, int* bz1) {
+    *bx0 = bucket_coord(min_x, grid->origin_x, grid->bucket_size, grid->bw);
+    *bx1 = bucket_coord(max_x, grid->origin_x, grid->bucket_size, grid->bw);
+    *bz0 = bucket_coord(min_z, grid->origin_z, grid->bucket_size, grid->bh);
+    *bz1 = bucket_coord(max_z, grid->origin_z, grid->bucket_size, grid->bh);
+}
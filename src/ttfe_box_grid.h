@@ -0,0 +1,53 @@
+/**\file ttfe_box_grid.h
+ *  uniform grid over the box AABBs, for projectile vs box tests
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#ifndef TTFE_BOX_GRID_HEADER_FOR_HACKS
+#define TTFE_BOX_GRID_HEADER_FOR_HACKS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ttfe_vector3d.h"
+#include "ttfe_entities.h"
+
+/* voxel cells per grid bucket side */
+#define BOX_GRID_CELLS 4
+
+/*
+ * XZ buckets aligned on the voxel field cells. Each box is listed in every
+ * bucket its AABB overlaps, packed per bucket (bucket_start / items, a
+ * counting sort), so a point only has to test the boxes of its bucket.
+ * Positions outside the field are clamped to the border buckets, where the
+ * obstacles spawn and leave. Rebuilt from scratch each tick, obstacles move.
+ */
+typedef struct {
+    float origin_x, origin_z; /* world coord of bucket (0,0) left/back corner */
+    float bucket_size;        /* world size of one bucket */
+    int bw, bh;               /* grid width / height in buckets */
+    int* bucket_start;        /* bw*bh+1 offsets into items */
+    int* cursor;              /* bw*bh fill positions, rebuild scratch */
+    int* items;               /* entity indices in the box pool */
+    int item_capacity;
+} BoxGrid;
+
+/* size the grid for a level voxel field */
+bool box_grid_setup(BoxGrid* grid, const VoxelField* vf);
+/* free the grid */
+void box_grid_free(BoxGrid* grid);
+/* list the active boxes of pool in the buckets they overlap */
+bool box_grid_rebuild(BoxGrid* grid, const EntityPool* boxes);
+/* bucket range [bx0, bx1] x [bz0, bz1] overlapped by an xz rectangle */
+void box_grid_range(const BoxGrid* grid, float min_x, float min_z, float max_x, float max_z, int* bx0, int* bz0, int* bx1, int* bz1);
+/* boxes listed in bucket (bx, bz): sets *items to their pool indices and returns their count. Released boxes stay listed until the next rebuild */
+int box_grid_bucket(const BoxGrid* grid, int bx, int bz, const int** items);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -10,14 +10,21 @@
 /* init pool of entities */
 void pool_init(EntityPool* pool, int capacity) {
     pool->entities = (GameEntity*)calloc(capacity, sizeof(GameEntity));
-    pool->count = 0;
+    pool->active = (int*)malloc(sizeof(int) * capacity);
+    pool->free_slots = (int*)malloc(sizeof(int) * capacity);
+    pool->active_pos = (int*)malloc(sizeof(int) * capacity);
     pool->capacity = capacity;
+    pool_clear(pool);
 }
 
 /* free pool of entities */
 void pool_free(EntityPool* pool) {
     free(pool->entities);
+    free(pool->active);
+    free(pool->free_slots);
+    free(pool->active_pos);
     pool->entities = NULL;
+    pool->active = pool->free_slots = pool->active_pos = NULL;
     pool->count = pool->capacity = 0;
 }
 
@@ -25,6 +32,9 @@ void pool_free(EntityPool* pool) {
 void pool_clear(EntityPool* pool) {
     for (int i = 0; i < pool->capacity; ++i) {
         pool->entities[i].flags = ENTITY_FLAG_NONE;
+        pool->active_pos[i] = -1;
+        /* lowest slots on top of the stack, same order as the old first-fit */
+        pool->free_slots[i] = pool->capacity - 1 - i;
     }
     pool->count = 0;
 }
@@ -50,25 +60,39 @@ void entity_deactivate(GameEntity* e) {
     e->flags &= ~ENTITY_FLAG_ACTIVE;
 }
 
-/* Find first inactive entity in pool, returns NULL if full */
+/* Take a free entity from the pool (flagged active), returns NULL if full */
 GameEntity* pool_alloc(EntityPool* pool) {
-    for (int i = 0; i < pool->capacity; ++i) {
-        if (!entity_is_active(&pool->entities[i])) {
-            pool->count++;
-            return &pool->entities[i];
-        }
-    }
-    return NULL;
+    if (pool->count >= pool->capacity) return NULL;
+
+    int slot = pool->free_slots[pool->capacity - 1 - pool->count];
+    pool->active_pos[slot] = pool->count;
+    pool->active[pool->count++] = slot;
+
+    GameEntity* e = &pool->entities[slot];
+    e->flags = ENTITY_FLAG_ACTIVE;
+    return e;
+}
+
+/* Give an entity back to the pool (no-op if it is not allocated) */
+void pool_release(EntityPool* pool, GameEntity* e) {
+    int slot = (int)(e - pool->entities);
+    int pos = pool->active_pos[slot];
+    if (pos < 0) return;
+
+    entity_deactivate(e);
+
+    /* swap-remove from the active list */
+    int last = pool->active[--pool->count];
+    pool->active[pos] = last;
+    pool->active_pos[last] = pos;
+    pool->active_pos[slot] = -1;
+
+    pool->free_slots[pool->capacity - 1 - pool->count] = slot;
 }
 
 /* Count active entities */
 int pool_active_count(const EntityPool* pool) {
-    int count = 0;
-    for (int i = 0; i < pool->capacity; ++i) {
-        if (entity_is_active(&pool->entities[i]))
-            count++;
-    }
-    return count;
+    return pool->count;
 }
 
 /* ENTITY FACTORY FUNCTIONS */
@@ -150,20 +174,6 @@ void entity_init_pink_light(GameEntity* e, Vec3 pos, float radius) {
     e->flags = ENTITY_FLAG_ACTIVE;
 }
 
-/* Create a snowflake entity (2D screen space) */
-void entity_init_snowflake(GameEntity* e, float x, float y, float vy, float size) {
-    e->pos = v_make(x, y, 0.0f);
-    e->vel = v_make(0.0f, vy, 0.0f);
-    e->prev_pos = e->pos;
-    e->color = al_map_rgb(255, 255, 255);
-    e->size = size;
-    e->lifetime = 0.0f;
-    e->hp = 1;
-    e->max_hp = e->hp;
-    e->phase = 0.0f;
-    e->flags = ENTITY_FLAG_ACTIVE;
-}
-
 /* Create a moving obstacle box */
 void entity_init_obstacle(GameEntity* e, Vec3 pos, Vec3 vel, float size) {
     e->pos = pos;
@@ -216,58 +226,25 @@ bool entity_update_projectile(GameEntity* e, float dt) {
     return true;
 }
 
-/* Update snowflake (2D) */
-void entity_update_snowflake(GameEntity* e, float dt, float screen_height) {
-    if (!entity_is_active(e)) return;
-
-    e->pos.y += e->vel.y * dt;
-
-    if (e->pos.y - e->size > screen_height) {
-        e->pos.y = frandf(-screen_height * 0.5f, 0.0f);
-        e->pos.x = frandf(0.0f, screen_height * 1.6f); /* approximate width */
-        e->vel.y = frandf(30.0f, 80.0f);
-        e->size = frandf(2.0f, 6.0f);
-    }
-}
-
 /* ENTITY RENDERING HELPERS */
 
-/* Add billboard quad for entity to vertex array */
-void entity_add_billboard(const GameEntity* e, VertexArray* va, Vec3 cam_right, Vec3 cam_up) {
-    if (!entity_is_active(e)) return;
-
-    Vec3 right = v_scale(cam_right, e->size);
-    Vec3 up = v_scale(cam_up, e->size);
-
-    Vec3 p0 = v_add(e->pos, v_add(v_scale(right, -1.0f), v_scale(up, -1.0f)));
-    Vec3 p1 = v_add(e->pos, v_add(right, v_scale(up, -1.0f)));
-    Vec3 p2 = v_add(e->pos, v_add(right, up));
-    Vec3 p3 = v_add(e->pos, v_add(v_scale(right, -1.0f), up));
-
-    va_reserve(va, 6);
-    ALLEGRO_VERTEX* v = va->v + va->count;
-
-    v[0] = (ALLEGRO_VERTEX){p0.x, p0.y, p0.z, 0, 0, e->color};
-    v[1] = (ALLEGRO_VERTEX){p1.x, p1.y, p1.z, 0, 0, e->color};
-    v[2] = (ALLEGRO_VERTEX){p2.x, p2.y, p2.z, 0, 0, e->color};
-    v[3] = (ALLEGRO_VERTEX){p0.x, p0.y, p0.z, 0, 0, e->color};
-    v[4] = (ALLEGRO_VERTEX){p2.x, p2.y, p2.z, 0, 0, e->color};
-    v[5] = (ALLEGRO_VERTEX){p3.x, p3.y, p3.z, 0, 0, e->color};
-
-    va->count += 6;
+/* Position to draw, alpha in [0,1] going from prev_pos (last tick) to pos (this tick) */
+Vec3 entity_render_pos(const GameEntity* e, float alpha) {
+    return v_lerp(e->prev_pos, e->pos, alpha);
 }
 
-/* Add box (cube) for entity to vertex array */
-void entity_add_box(const GameEntity* e, VertexArray* va, ALLEGRO_COLOR shade_top) {
+/* Add box (cube) for entity to vertex array, at its render position for alpha */
+void entity_add_box(const GameEntity* e, VertexArray* va, ALLEGRO_COLOR shade_top, float alpha) {
     if (!entity_is_active(e)) return;
 
+    Vec3 pos = entity_render_pos(e, alpha);
     float hs = e->size;
-    float x = e->pos.x;
-    float y = e->pos.y;
-    float z = e->pos.z;
+    float x = pos.x;
+    float y = pos.y;
+    float z = pos.z;
     ALLEGRO_COLOR c = e->color;
 
-    va_reserve(va, 36);
+    va_reserve(va, 24);
     ALLEGRO_VERTEX* v = va->v + va->count;
     int idx = 0;
 
@@ -275,51 +252,42 @@ void entity_add_box(const GameEntity* e, VertexArray* va, ALLEGRO_COLOR shade_to
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y + hs, z - hs, 0, 0, shade_top};
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y + hs, z - hs, 0, 0, shade_top};
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y + hs, z + hs, 0, 0, shade_top};
-    v[idx++] = (ALLEGRO_VERTEX){x - hs, y + hs, z - hs, 0, 0, shade_top};
-    v[idx++] = (ALLEGRO_VERTEX){x + hs, y + hs, z + hs, 0, 0, shade_top};
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y + hs, z + hs, 0, 0, shade_top};
 
     /* bottom */
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y - hs, z + hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y - hs, z + hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y - hs, z - hs, 0, 0, c};
-    v[idx++] = (ALLEGRO_VERTEX){x - hs, y - hs, z + hs, 0, 0, c};
-    v[idx++] = (ALLEGRO_VERTEX){x + hs, y - hs, z - hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y - hs, z - hs, 0, 0, c};
 
     /* +X */
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y - hs, z - hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y - hs, z + hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y + hs, z + hs, 0, 0, c};
-    v[idx++] = (ALLEGRO_VERTEX){x + hs, y - hs, z - hs, 0, 0, c};
-    v[idx++] = (ALLEGRO_VERTEX){x + hs, y + hs, z + hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y + hs, z - hs, 0, 0, c};
 
     /* -X */
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y - hs, z + hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y - hs, z - hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y + hs, z - hs, 0, 0, c};
-    v[idx++] = (ALLEGRO_VERTEX){x - hs, y - hs, z + hs, 0, 0, c};
-    v[idx++] = (ALLEGRO_VERTEX){x - hs, y + hs, z - hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y + hs, z + hs, 0, 0, c};
 
     /* +Z */
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y - hs, z + hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y - hs, z + hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y + hs, z + hs, 0, 0, c};
-    v[idx++] = (ALLEGRO_VERTEX){x - hs, y - hs, z + hs, 0, 0, c};
-    v[idx++] = (ALLEGRO_VERTEX){x + hs, y + hs, z + hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y + hs, z + hs, 0, 0, c};
 
     /* -Z */
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y - hs, z - hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y - hs, z - hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x - hs, y + hs, z - hs, 0, 0, c};
-    v[idx++] = (ALLEGRO_VERTEX){x + hs, y - hs, z - hs, 0, 0, c};
-    v[idx++] = (ALLEGRO_VERTEX){x - hs, y + hs, z - hs, 0, 0, c};
     v[idx++] = (ALLEGRO_VERTEX){x + hs, y + hs, z - hs, 0, 0, c};
 
-    va->count += 36;
+    for (int face = 0; face < 6; face++) {
+        va_add_quad_indices(va, va->count + face * 4);
+    }
+    va->count += 24;
 }
 
 /* COLLISION HELPERS */
@@ -42,10 +42,21 @@ typedef struct {
 
 /* ENTITY POOL - Generic pool management */
 
+/*
+ * Allocated slots are listed densely in active[0, count), free slots are a
+ * stack in free_slots[0, capacity - count). Allocation and release are O(1)
+ * and loops walk active[] instead of the whole capacity:
+ *   for (int k = 0; k < pool->count; ++k) { GameEntity* e = &pool->entities[pool->active[k]]; ... }
+ * Release swaps the last active slot into the released position, so loops
+ * that release should walk active[] backwards.
+ */
 typedef struct {
     GameEntity* entities;
-    int count;    /* number of entities in use */
-    int capacity; /* maximum capacity */
+    int* active;     /* indices of the allocated slots */
+    int* free_slots; /* indices of the free slots */
+    int* active_pos; /* position of each slot in active[], -1 when free */
+    int count;       /* number of entities in use */
+    int capacity;    /* maximum capacity */
 } EntityPool;
 
 /* init pool of entities */
@@ -62,8 +73,10 @@ bool entity_is_active(const GameEntity* e);
 void entity_activate(GameEntity* e);
 /* deactivate an entity in the pool */
 void entity_deactivate(GameEntity* e);
-/* Find first inactive entity in pool, returns NULL if full */
+/* Take a free entity from the pool (flagged active), returns NULL if full */
 GameEntity* pool_alloc(EntityPool* pool);
+/* Give an entity back to the pool (no-op if it is not allocated) */
+void pool_release(EntityPool* pool, GameEntity* e);
 /* Count active entities */
 int pool_active_count(const EntityPool* pool);
 
@@ -79,8 +92,6 @@ void entity_init_projectile(GameEntity* e, Vec3 pos, Vec3 vel, float lifetime);
 void entity_init_box(GameEntity* e, Vec3 pos, float half_size, uint32_t bonus_flags);
 /* Create a pink light entity */
 void entity_init_pink_light(GameEntity* e, Vec3 pos, float radius);
-/* Create a snowflake entity (2D screen space) */
-void entity_init_snowflake(GameEntity* e, float x, float y, float vy, float size);
 /* Create a moving obstacle box */
 void entity_init_obstacle(GameEntity* e, Vec3 pos, Vec3 vel, float size);
 
@@ -90,15 +101,13 @@ void entity_init_obstacle(GameEntity* e, Vec3 pos, Vec3 vel, float size);
 bool entity_update_particle(GameEntity* e, float dt, float gravity);
 /* Update projectile */
 bool entity_update_projectile(GameEntity* e, float dt);
-/* Update snowflake (2D) */
-void entity_update_snowflake(GameEntity* e, float dt, float screen_height);
 
 /*  ENTITY RENDERING HELPERS */
 
-/* Add billboard quad for entity to vertex array */
-void entity_add_billboard(const GameEntity* e, VertexArray* va, Vec3 cam_right, Vec3 cam_up);
-/* Add box (cube) for entity to vertex array */
-void entity_add_box(const GameEntity* e, VertexArray* va, ALLEGRO_COLOR shade_top);
+/* Position to draw, alpha in [0,1] going from prev_pos (last tick) to pos (this tick) */
+Vec3 entity_render_pos(const GameEntity* e, float alpha);
+/* Add box (cube) for entity to vertex array, at its render position for alpha */
+void entity_add_box(const GameEntity* e, VertexArray* va, ALLEGRO_COLOR shade_top, float alpha);
 
 /* COLLISION HELPERS */
 
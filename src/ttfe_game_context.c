@@ -20,26 +20,28 @@ void game_context_init(GameContext* ctx, float base_move_speed) {
 
     /* Initialize entity pools */
     pool_init(&ctx->stars, STAR_COUNT);
+    starfield_mesh_init(&ctx->starfield, STAR_COUNT);
     pool_init(&ctx->boxes, MAX_BOXES + MAX_HITTING_BOXES);
     pool_init(&ctx->projectiles, MAX_PROJECTILES);
-    pool_init(&ctx->particles, MAX_PARTICLES);
+    particle_pool_init(&ctx->particles, MAX_PARTICLES);
     pool_init(&ctx->pink_lights, PINK_LIGHT_MAX);
-    pool_init(&ctx->intro_snow, INTRO_SNOW_COUNT);
+    particle_pool_init(&ctx->intro_snow, INTRO_SNOW_COUNT);
 
     /* Initialize vertex arrays */
-    va_init(&ctx->va_stars, STAR_COUNT * 6);
-    va_init(&ctx->va_boxes, (MAX_BOXES + MAX_HITTING_BOXES) * 36);
-    va_init(&ctx->va_particles, MAX_PARTICLES * 6);
-    va_init(&ctx->va_pink_lights, PINK_LIGHT_MAX * 6);
-    va_init(&ctx->va_projectiles, MAX_PROJECTILES * 6);
+    va_init(&ctx->va_boxes, (MAX_BOXES + MAX_HITTING_BOXES) * 24);
+    va_init(&ctx->va_particles, MAX_PARTICLES * 4);
+    va_init(&ctx->va_pink_lights, PINK_LIGHT_MAX * 4);
+    va_init(&ctx->va_projectiles, MAX_PROJECTILES * 8); /* sprite and trail quads */
     va_init(&ctx->va_level, 4096);
     va_init(&ctx->va_overlay_letters, 4096);
     va_init(&ctx->va_overlay_goals, 1024);
+    particle_batch_init(&ctx->batch_2d, INTRO_SNOW_COUNT);
 
     /* Default values */
     ctx->state = STATE_PLAY;
     ctx->party_result = PARTY_UNDECIDED;
     ctx->gravity_enabled = true;
+    ctx->projectile_trails = true;
     ctx->on_ground = true;
     ctx->move_speed = base_move_speed;
     ctx->max_speed = base_move_speed;
@@ -65,13 +67,17 @@ void game_context_init(GameContext* ctx, float base_move_speed) {
 
 void game_context_free(GameContext* ctx) {
     pool_free(&ctx->stars);
+    starfield_mesh_free(&ctx->starfield);
     pool_free(&ctx->boxes);
     pool_free(&ctx->projectiles);
-    pool_free(&ctx->particles);
+    particle_pool_free(&ctx->particles);
     pool_free(&ctx->pink_lights);
-    pool_free(&ctx->intro_snow);
+    particle_pool_free(&ctx->intro_snow);
+    box_grid_free(&ctx->box_grid);
+    level_chunks_free(&ctx->chunks_level);
+    level_chunks_free(&ctx->chunks_overlay_letters);
+    level_chunks_free(&ctx->chunks_overlay_goals);
 
-    va_free(&ctx->va_stars);
     va_free(&ctx->va_boxes);
     va_free(&ctx->va_particles);
     va_free(&ctx->va_pink_lights);
@@ -79,16 +85,16 @@ void game_context_free(GameContext* ctx) {
     va_free(&ctx->va_level);
     va_free(&ctx->va_overlay_letters);
     va_free(&ctx->va_overlay_goals);
+    particle_batch_free(&ctx->batch_2d);
 
-    if (ctx->vf.solid) free(ctx->vf.solid);
-    if (ctx->vf.is_goal) free(ctx->vf.is_goal);
+    voxel_field_free(&ctx->vf);
     free(ctx->render_state);
 }
 
 void game_context_reset_level(GameContext* ctx) {
     pool_clear(&ctx->boxes);
     pool_clear(&ctx->projectiles);
-    pool_clear(&ctx->particles);
+    particle_pool_clear(&ctx->particles);
     pool_clear(&ctx->pink_lights);
 
     ctx->state = STATE_PLAY;
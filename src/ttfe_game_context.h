@@ -17,13 +17,20 @@ extern "C" {
 
 #include "ttfe_vector3d.h"
 #include "ttfe_entities.h"
+#include "ttfe_particle_pool.h"
+#include "ttfe_particle_batch.h"
+#include "ttfe_box_grid.h"
 #include "ttfe_vbo.h"
+#include "ttfe_tint.h"
+#include "ttfe_level_cache.h"
+#include "ttfe_level_chunks.h"
+#include "ttfe_stars.h"
 
 #define STAR_COUNT 16384
 #define MAX_BOXES 64
 #define MAX_HITTING_BOXES 16
 #define MAX_PROJECTILES 128
-#define MAX_PARTICLES 2048
+#define MAX_PARTICLES 32768
 #define INTRO_SNOW_COUNT 400
 #define PINK_LIGHT_MAX 256
 
@@ -45,12 +52,13 @@ typedef struct {
     EntityPool stars;
     EntityPool boxes;
     EntityPool projectiles;
-    EntityPool particles;
+    ParticlePool particles;
     EntityPool pink_lights;
-    EntityPool intro_snow;
+    ParticlePool intro_snow; /* screen space */
+    /* box buckets for the projectile tests */
+    BoxGrid box_grid;
 
     /* Vertex arrays for rendering */
-    VertexArray va_stars;
     VertexArray va_boxes;
     VertexArray va_particles;
     VertexArray va_pink_lights;
@@ -58,11 +66,14 @@ typedef struct {
     VertexArray va_level;
     VertexArray va_overlay_letters;
     VertexArray va_overlay_goals;
+    /* intro snow and outro confetti */
+    ParticleBatch2D batch_2d;
 
     /* Game state */
     GameState state;
     PartyResult party_result;
     Camera cam;
+    Vec3 cam_prev_pos; /* camera position at the start of the last tick, for render interpolation */
 
     int score;
     int total_score;
@@ -79,6 +90,7 @@ typedef struct {
     bool paused;
     bool mouse_locked;
     bool cheat_code_used;
+    bool projectile_trails; /* draw a motion trail behind each projectile */
 
     /* Level info */
     VoxelField vf;
@@ -104,6 +116,20 @@ typedef struct {
 
     /* VBO object */
     TTFE_VBO g_ttfe_stream_vbo;
+    /* static level geometry, uploaded once per level */
+    TTFE_VBO vbo_level;
+    TTFE_VBO vbo_overlay_letters;
+    TTFE_VBO vbo_overlay_goals;
+    /* glow color applied to the static overlays */
+    TTFE_TINT glow_tint;
+    /* stars of the current level, baked */
+    StarfieldMesh starfield;
+    /* frustum culling chunks of va_level and of the overlays */
+    LevelChunks chunks_level;
+    LevelChunks chunks_overlay_letters;
+    LevelChunks chunks_overlay_goals;
+    /* on-disk cache of built levels */
+    LevelCache level_cache;
 
 } GameContext;
 
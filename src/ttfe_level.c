@@ -8,6 +8,7 @@
 #include "ttfe_level.h"
 #include "ttfe_color.h"
 #include "ttfe_loading.h"
+#include "ttfe_level_chunks.h"
 #include "nilorea/n_log.h"
 
 #ifdef __EMSCRIPTEN__
@@ -21,8 +22,78 @@ void wasm_yield(void) {
 }
 #endif
 
-/* build a level from a font */
-int build_level_geometry(GameContext* ctx, ALLEGRO_FONT* level_font, ALLEGRO_FONT* gui_font, const char* phrase, int phrase_len, int level_font_size) {
+#ifdef __EMSCRIPTEN__
+#define VOXELIZE_THREADS 1
+#else
+#define VOXELIZE_THREADS 4
+#endif
+
+/* rows [gy0, gy1) of the voxel field to fill from a locked ABGR_8888_LE text bitmap */
+typedef struct {
+    const unsigned char* pixels;
+    int pitch;
+    int bmp_w, bmp_h;
+    int step;
+    const unsigned char* goal_col; /* 1 if column gx samples inside the goal character */
+    VoxelField* vf;
+    int gy0, gy1;
+} VoxelizeBand;
+
+/* fill the cell flags for a band of rows */
+static void voxelize_rows(VoxelizeBand* band) {
+    VoxelField* vf = band->vf;
+    for (int gy = band->gy0; gy < band->gy1; gy++) {
+        int py = gy * band->step + band->step / 2;
+        py = py > band->bmp_h - 1 ? band->bmp_h - 1 : py;
+        const unsigned char* row = band->pixels + (ptrdiff_t)py * band->pitch;
+
+        for (int gx = 0; gx < vf->gw; gx++) {
+            int px = gx * band->step + band->step / 2;
+            px = px > band->bmp_w - 1 ? band->bmp_w - 1 : px;
+
+            /* alpha is the 4th byte of an ABGR_8888_LE pixel */
+            if (row[px * 4 + 3] > 20) {
+                vf->cells[gy * vf->gw + gx] = band->goal_col[gx] ? VOXEL_SOLID | VOXEL_GOAL : VOXEL_SOLID;
+            }
+        }
+    }
+}
+
+/* worker thread entry for voxelize_rows */
+static void* voxelize_thread(ALLEGRO_THREAD* thread, void* arg) {
+    (void)thread;
+    voxelize_rows((VoxelizeBand*)arg);
+    return NULL;
+}
+
+/* merge key of a cell for greedy meshing: -1 = empty, 0 = letter, 1 = goal */
+static int cell_kind(const VoxelField* vf, int gx, int gy) {
+    unsigned char c = voxel_cell(vf, gx, gy);
+    if (!(c & VOXEL_SOLID)) return -1;
+    return (c & VOXEL_GOAL) != 0;
+}
+
+/* destination arrays of build_level_meshes */
+typedef struct {
+    VertexArray* level;
+    VertexArray* letters;
+    VertexArray* goals;
+} LevelMeshTarget;
+
+/* add one (merged) face to the level mesh and to the matching overlay (white, tinted at draw time) */
+static void add_level_face(const LevelMeshTarget* out, int kind, float nx, float ny, float nz, float x1, float y1, float z1, float x2, float y2, float z2, float x3, float y3, float z3, float x4, float y4, float z4) {
+    ALLEGRO_COLOR base = kind ? al_map_rgb(0x00, 0xff, 0x00) : al_map_rgb(0x36, 0x01, 0x3f);
+    ALLEGRO_COLOR white = al_map_rgb(255, 255, 255);
+    VertexArray* overlay = kind ? out->goals : out->letters;
+
+    va_add_quad(out->level, x1, y1, z1, x2, y2, z2, x3, y3, z3, x4, y4, z4, shade_color(base, nx, ny, nz));
+    va_add_quad(overlay, x1, y1, z1, x2, y2, z2, x3, y3, z3, x4, y4, z4, white);
+}
+
+/* rasterize the phrase and fill vf from it. Needs the display thread (font + bitmap) */
+int build_level_voxels(VoxelField* vf, ALLEGRO_FONT* level_font, LoadingProgress* progress, const char* phrase, int phrase_len, int level_font_size) {
+    ALLEGRO_STATE state;
+
     int text_w = al_get_text_width(level_font, phrase);
     int text_h = al_get_font_line_height(level_font);
 
@@ -36,23 +107,26 @@ int build_level_geometry(GameContext* ctx, ALLEGRO_FONT* level_font, ALLEGRO_FON
         return FALSE;
     }
 
-    al_store_state(ctx->render_state, ALLEGRO_STATE_TARGET_BITMAP | ALLEGRO_STATE_BLENDER);
+    al_store_state(&state, ALLEGRO_STATE_TARGET_BITMAP | ALLEGRO_STATE_BLENDER);
     al_set_target_bitmap(text_bmp);
     al_clear_to_color(al_map_rgba(0, 0, 0, 0));
     al_draw_text(level_font, al_map_rgb(255, 255, 255),
                  bmp_w / 2.0f, (bmp_h - text_h) / 2.0f,
                  ALLEGRO_ALIGN_CENTRE, phrase);
-    al_restore_state(ctx->render_state);
-
-    const int STEP = 4;
-    ctx->vf.gw = (bmp_w + STEP - 1) / STEP;
-    ctx->vf.gh = (bmp_h + STEP - 1) / STEP;
-    ctx->vf.cell_size = 3.0f;
-    ctx->vf.extrude_h = 40.0f;
-    ctx->vf.origin_x = -(float)ctx->vf.gw * ctx->vf.cell_size * 0.5f;
-    ctx->vf.origin_z = -(float)ctx->vf.gh * ctx->vf.cell_size * 0.5f;
-    ctx->vf.solid = (int*)calloc(ctx->vf.gw * ctx->vf.gh, sizeof(int));
-    ctx->vf.is_goal = (int*)calloc(ctx->vf.gw * ctx->vf.gh, sizeof(int));
+    al_restore_state(&state);
+
+    const int STEP = LEVEL_VOXEL_STEP;
+    vf->gw = (bmp_w + STEP - 1) / STEP;
+    vf->gh = (bmp_h + STEP - 1) / STEP;
+    vf->cell_size = LEVEL_CELL_SIZE;
+    vf->extrude_h = LEVEL_EXTRUDE_H;
+    vf->origin_x = -(float)vf->gw * vf->cell_size * 0.5f;
+    vf->origin_z = -(float)vf->gh * vf->cell_size * 0.5f;
+    if (!voxel_field_alloc(vf)) {
+        n_log(LOG_ERR, "Failed to allocate voxel field");
+        al_destroy_bitmap(text_bmp);
+        return FALSE;
+    }
 
     /* Identify goal ranges */
     typedef struct {
@@ -80,117 +154,214 @@ int build_level_geometry(GameContext* ctx, ALLEGRO_FONT* level_font, ALLEGRO_FON
             goal_ranges[goal_range_count].x1 = text_start_x + (float)w_curr;
             goal_range_count++;
         }
-        draw_text_box_with_progress("Loading assets...", gui_font, ctx->dw / 2, ctx->dh / 2 - 100,
-                                    al_map_rgb(255, 255, 255),    /* text */
-                                    al_map_rgba(20, 20, 20, 220), /* bg */
-                                    al_map_rgb(255, 255, 255),    /* border */
-                                    al_map_rgb(80, 200, 120),     /* bar */
-                                    0, phrase_len, i);
+        loading_progress_report(progress, "Loading assets...", 0, phrase_len, i);
     }
 
-    /* Fill solid & is_goal */
-    for (int gy = 0; gy < ctx->vf.gh; gy++) {
-        for (int gx = 0; gx < ctx->vf.gw; gx++) {
-            int px = gx * STEP + STEP / 2;
-            int py = gy * STEP + STEP / 2;
-            px = clampf(px, 0, bmp_w - 1);
-            py = clampf(py, 0, bmp_h - 1);
-
-            ALLEGRO_COLOR c = al_get_pixel(text_bmp, px, py);
-            unsigned char r, g, b, a;
-            al_unmap_rgba(c, &r, &g, &b, &a);
-
-            if (a > 20) {
-                int idx = gy * ctx->vf.gw + gx;
-                ctx->vf.solid[idx] = 1;
-
-                for (int dr = 0; dr < goal_range_count; ++dr) {
-                    if ((float)px >= goal_ranges[dr].x0 && (float)px < goal_ranges[dr].x1) {
-                        ctx->vf.is_goal[idx] = 1;
-                        break;
-                    }
-                }
+    /* Goal membership only depends on the sampled column */
+    unsigned char* goal_col = (unsigned char*)calloc((size_t)vf->gw, sizeof(unsigned char));
+    if (!goal_col) {
+        n_log(LOG_ERR, "Failed to allocate goal column lookup");
+        al_destroy_bitmap(text_bmp);
+        return FALSE;
+    }
+    for (int gx = 0; gx < vf->gw; gx++) {
+        int px = gx * STEP + STEP / 2;
+        px = px > bmp_w - 1 ? bmp_w - 1 : px;
+        for (int dr = 0; dr < goal_range_count; ++dr) {
+            if ((float)px >= goal_ranges[dr].x0 && (float)px < goal_ranges[dr].x1) {
+                goal_col[gx] = 1;
+                break;
             }
         }
-        draw_text_box_with_progress("Fill glyphs...", gui_font, ctx->dw / 2, ctx->dh / 2 - 100,
-                                    al_map_rgb(255, 255, 255),    /* text */
-                                    al_map_rgba(20, 20, 20, 220), /* bg */
-                                    al_map_rgb(255, 255, 255),    /* border */
-                                    al_map_rgb(80, 200, 120),     /* bar */
-                                    0, ctx->vf.gh, gy);
-
-        wasm_yield();
     }
 
-    /* Build vertex arrays */
-    va_clear(&ctx->va_level);
-    va_clear(&ctx->va_overlay_letters);
-    va_clear(&ctx->va_overlay_goals);
+    /* Fill the cell flags from the raw pixels, one row band per worker */
+    loading_progress_report(progress, "Fill glyphs...", 0, vf->gh, 0);
 
-    ALLEGRO_COLOR base_letter = al_map_rgb(0x36, 0x01, 0x3f);
-    ALLEGRO_COLOR base_goal = al_map_rgb(0x00, 0xff, 0x00);
-    ALLEGRO_COLOR dummy = al_map_rgba(0, 0, 0, 0);
+    ALLEGRO_LOCKED_REGION* lr = al_lock_bitmap(text_bmp, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_READONLY);
+    if (!lr) {
+        n_log(LOG_ERR, "Failed to lock text bitmap");
+        free(goal_col);
+        al_destroy_bitmap(text_bmp);
+        return FALSE;
+    }
 
-    for (int gy = 0; gy < ctx->vf.gh; gy++) {
-        for (int gx = 0; gx < ctx->vf.gw; gx++) {
-            if (!is_solid(&ctx->vf, gx, gy)) continue;
+    VoxelizeBand bands[VOXELIZE_THREADS];
+    ALLEGRO_THREAD* threads[VOXELIZE_THREADS] = {NULL};
+    int band_count = vf->gh < VOXELIZE_THREADS * 16 ? 1 : VOXELIZE_THREADS;
+    int rows_per_band = (vf->gh + band_count - 1) / band_count;
+
+    for (int b = 0; b < band_count; b++) {
+        bands[b].pixels = (const unsigned char*)lr->data;
+        bands[b].pitch = lr->pitch;
+        bands[b].bmp_w = bmp_w;
+        bands[b].bmp_h = bmp_h;
+        bands[b].step = STEP;
+        bands[b].goal_col = goal_col;
+        bands[b].vf = vf;
+        bands[b].gy0 = b * rows_per_band;
+        bands[b].gy1 = (b + 1) * rows_per_band > vf->gh ? vf->gh : (b + 1) * rows_per_band;
+
+        /* band 0 runs on the calling thread */
+        if (b > 0) {
+            threads[b] = al_create_thread(voxelize_thread, &bands[b]);
+            if (threads[b]) al_start_thread(threads[b]);
+        }
+    }
+    voxelize_rows(&bands[0]);
+    for (int b = 1; b < band_count; b++) {
+        if (threads[b]) {
+            al_join_thread(threads[b], NULL);
+            al_destroy_thread(threads[b]);
+        } else {
+            voxelize_rows(&bands[b]);
+        }
+    }
 
-            int idx = gy * ctx->vf.gw + gx;
-            bool isgoal = ctx->vf.is_goal[idx] != 0;
-            ALLEGRO_COLOR base = isgoal ? base_goal : base_letter;
+    al_unlock_bitmap(text_bmp);
+    free(goal_col);
+    wasm_yield();
 
-            float x0 = ctx->vf.origin_x + gx * ctx->vf.cell_size;
-            float x1 = x0 + ctx->vf.cell_size;
-            float z0 = ctx->vf.origin_z + gy * ctx->vf.cell_size;
-            float z1 = z0 + ctx->vf.cell_size;
-            float y0 = 0.0f;
-            float y1 = ctx->vf.extrude_h;
+    al_destroy_bitmap(text_bmp);
+    return TRUE;
+}
 
-            ALLEGRO_COLOR ctop = shade_color(base, 0.0f, 1.0f, 0.0f);
-            ALLEGRO_COLOR cbottom = shade_color(base, 0.0f, -1.0f, 0.0f);
+/* build the greedy level mesh and overlays from vf. Touches no Allegro state, safe on a worker thread */
+int build_level_meshes(const VoxelField* vf, VertexArray* va_level, VertexArray* va_letters, VertexArray* va_goals, LoadingProgress* progress) {
+    LevelMeshTarget out = {va_level, va_letters, va_goals};
 
-            /* Base geometry */
-            va_add_quad(&ctx->va_level, x0, y1, z0, x1, y1, z0, x1, y1, z1, x0, y1, z1, ctop);
-            va_add_quad(&ctx->va_level, x0, y0, z1, x1, y0, z1, x1, y0, z0, x0, y0, z0, cbottom);
+    va_clear(va_level);
+    va_clear(va_letters);
+    va_clear(va_goals);
 
-            /* Overlay geometry */
-            VertexArray* overlay = isgoal ? &ctx->va_overlay_goals : &ctx->va_overlay_letters;
-            va_add_quad(overlay, x0, y1, z0, x1, y1, z0, x1, y1, z1, x0, y1, z1, dummy);
-            va_add_quad(overlay, x0, y0, z1, x1, y0, z1, x1, y0, z0, x0, y0, z0, dummy);
+    unsigned char* merged = (unsigned char*)calloc((size_t)vf->gw * vf->gh, sizeof(unsigned char));
+    if (!merged) {
+        n_log(LOG_ERR, "Failed to allocate greedy meshing mask");
+        return FALSE;
+    }
 
-            /* Side faces */
-            if (!is_solid(&ctx->vf, gx + 1, gy)) {
-                ALLEGRO_COLOR c = shade_color(base, 1.0f, 0.0f, 0.0f);
-                va_add_quad(&ctx->va_level, x1, y0, z0, x1, y0, z1, x1, y1, z1, x1, y1, z0, c);
-                va_add_quad(overlay, x1, y0, z0, x1, y0, z1, x1, y1, z1, x1, y1, z0, dummy);
+    /* Top / bottom faces: merge same-kind cells into maximal rectangles */
+    for (int gy = 0; gy < vf->gh; gy++) {
+        for (int gx = 0; gx < vf->gw; gx++) {
+            int kind = cell_kind(vf, gx, gy);
+            if (kind < 0 || merged[gy * vf->gw + gx]) continue;
+
+            /* grow along x, up to the chunk border */
+            int w = 1;
+            while (gx + w < vf->gw && (gx + w) % LEVEL_CHUNK_CELLS != 0 && !merged[gy * vf->gw + gx + w] && cell_kind(vf, gx + w, gy) == kind) w++;
+
+            /* grow along z while the whole span matches */
+            int h = 1;
+            while (gy + h < vf->gh && (gy + h) % LEVEL_CHUNK_CELLS != 0) {
+                int k;
+                for (k = 0; k < w; k++) {
+                    if (merged[(gy + h) * vf->gw + gx + k] || cell_kind(vf, gx + k, gy + h) != kind) break;
+                }
+                if (k < w) break;
+                h++;
             }
-            if (!is_solid(&ctx->vf, gx - 1, gy)) {
-                ALLEGRO_COLOR c = shade_color(base, -1.0f, 0.0f, 0.0f);
-                va_add_quad(&ctx->va_level, x0, y0, z1, x0, y0, z0, x0, y1, z0, x0, y1, z1, c);
-                va_add_quad(overlay, x0, y0, z1, x0, y0, z0, x0, y1, z0, x0, y1, z1, dummy);
+
+            for (int dy = 0; dy < h; dy++) {
+                memset(&merged[(gy + dy) * vf->gw + gx], 1, (size_t)w);
             }
-            if (!is_solid(&ctx->vf, gx, gy + 1)) {
-                ALLEGRO_COLOR c = shade_color(base, 0.0f, 0.0f, 1.0f);
-                va_add_quad(&ctx->va_level, x0, y0, z1, x1, y0, z1, x1, y1, z1, x0, y1, z1, c);
-                va_add_quad(overlay, x0, y0, z1, x1, y0, z1, x1, y1, z1, x0, y1, z1, dummy);
+
+            float x0 = vf->origin_x + gx * vf->cell_size;
+            float x1 = x0 + w * vf->cell_size;
+            float z0 = vf->origin_z + gy * vf->cell_size;
+            float z1 = z0 + h * vf->cell_size;
+            float y0 = 0.0f;
+            float y1 = vf->extrude_h;
+
+            add_level_face(&out, kind, 0.0f, 1.0f, 0.0f, x0, y1, z0, x1, y1, z0, x1, y1, z1, x0, y1, z1);
+            add_level_face(&out, kind, 0.0f, -1.0f, 0.0f, x0, y0, z1, x1, y0, z1, x1, y0, z0, x0, y0, z0);
+        }
+        if (loading_progress_report(progress, "Build vertex arrays...", 0, vf->gh, gy))
+            wasm_yield();
+    }
+    free(merged);
+
+    /* +Z / -Z side faces: merge runs along x */
+    for (int gy = 0; gy < vf->gh; gy++) {
+        for (int side = 0; side < 2; side++) {
+            int ny = side == 0 ? gy + 1 : gy - 1;
+            int gx = 0;
+            while (gx < vf->gw) {
+                int kind = cell_kind(vf, gx, gy);
+                if (kind < 0 || is_solid(vf, gx, ny)) {
+                    gx++;
+                    continue;
+                }
+                int w = 1;
+                while (gx + w < vf->gw && (gx + w) % LEVEL_CHUNK_CELLS != 0 && cell_kind(vf, gx + w, gy) == kind && !is_solid(vf, gx + w, ny)) w++;
+
+                float x0 = vf->origin_x + gx * vf->cell_size;
+                float x1 = x0 + w * vf->cell_size;
+                float z0 = vf->origin_z + gy * vf->cell_size;
+                float z1 = z0 + vf->cell_size;
+                float y0 = 0.0f;
+                float y1 = vf->extrude_h;
+
+                if (side == 0)
+                    add_level_face(&out, kind, 0.0f, 0.0f, 1.0f, x0, y0, z1, x1, y0, z1, x1, y1, z1, x0, y1, z1);
+                else
+                    add_level_face(&out, kind, 0.0f, 0.0f, -1.0f, x1, y0, z0, x0, y0, z0, x0, y1, z0, x1, y1, z0);
+                gx += w;
             }
-            if (!is_solid(&ctx->vf, gx, gy - 1)) {
-                ALLEGRO_COLOR c = shade_color(base, 0.0f, 0.0f, -1.0f);
-                va_add_quad(&ctx->va_level, x1, y0, z0, x0, y0, z0, x0, y1, z0, x1, y1, z0, c);
-                va_add_quad(overlay, x1, y0, z0, x0, y0, z0, x0, y1, z0, x1, y1, z0, dummy);
+        }
+    }
+
+    /* +X / -X side faces: merge runs along z */
+    for (int gx = 0; gx < vf->gw; gx++) {
+        for (int side = 0; side < 2; side++) {
+            int nx = side == 0 ? gx + 1 : gx - 1;
+            int gy = 0;
+            while (gy < vf->gh) {
+                int kind = cell_kind(vf, gx, gy);
+                if (kind < 0 || is_solid(vf, nx, gy)) {
+                    gy++;
+                    continue;
+                }
+                int h = 1;
+                while (gy + h < vf->gh && (gy + h) % LEVEL_CHUNK_CELLS != 0 && cell_kind(vf, gx, gy + h) == kind && !is_solid(vf, nx, gy + h)) h++;
+
+                float x0 = vf->origin_x + gx * vf->cell_size;
+                float x1 = x0 + vf->cell_size;
+                float z0 = vf->origin_z + gy * vf->cell_size;
+                float z1 = z0 + h * vf->cell_size;
+                float y0 = 0.0f;
+                float y1 = vf->extrude_h;
+
+                if (side == 0)
+                    add_level_face(&out, kind, 1.0f, 0.0f, 0.0f, x1, y0, z0, x1, y0, z1, x1, y1, z1, x1, y1, z0);
+                else
+                    add_level_face(&out, kind, -1.0f, 0.0f, 0.0f, x0, y0, z1, x0, y0, z0, x0, y1, z0, x0, y1, z1);
+                gy += h;
             }
         }
-        draw_text_box_with_progress("Build vertex arrays...", gui_font, ctx->dw / 2, ctx->dh / 2 - 100,
-                                    al_map_rgb(255, 255, 255),    /* text */
-                                    al_map_rgba(20, 20, 20, 220), /* bg */
-                                    al_map_rgb(255, 255, 255),    /* border */
-                                    al_map_rgb(80, 200, 120),     /* bar */
-                                    0, ctx->vf.gh, gy);
-
-        wasm_yield();
     }
 
-    al_destroy_bitmap(text_bmp);
+    n_log(LOG_DEBUG, "level mesh: %d level vertices, %d letter overlay vertices, %d goal overlay vertices",
+          va_level->count, va_letters->count, va_goals->count);
+
+    return TRUE;
+}
+
+/* build a level from a font, or load it from the level cache */
+int build_level_geometry(GameContext* ctx, ALLEGRO_FONT* level_font, ALLEGRO_FONT* gui_font, const char* phrase, int phrase_len, int level_font_size) {
+    LoadingProgress progress;
+    loading_progress_init(&progress, gui_font, ctx->dw / 2, ctx->dh / 2 - 100, LOADING_PROGRESS_INTERVAL);
+
+    uint64_t key = level_cache_key(&ctx->level_cache, phrase, level_font_size);
+    if (level_cache_load(&ctx->level_cache, key, &ctx->vf, &ctx->va_level, &ctx->va_overlay_letters, &ctx->va_overlay_goals)) {
+        n_log(LOG_DEBUG, "level '%s' loaded from cache", phrase);
+        return TRUE;
+    }
+
+    if (!build_level_voxels(&ctx->vf, level_font, &progress, phrase, phrase_len, level_font_size))
+        return FALSE;
+    if (!build_level_meshes(&ctx->vf, &ctx->va_level, &ctx->va_overlay_letters, &ctx->va_overlay_goals, &progress))
+        return FALSE;
+    level_cache_store(&ctx->level_cache, key, &ctx->vf, &ctx->va_level, &ctx->va_overlay_letters, &ctx->va_overlay_goals);
     return TRUE;
 }
 
@@ -303,6 +474,7 @@ void setup_camera_start(GameContext* ctx) {
     ctx->cam.position.x = ctx->vf.origin_x + gx_center_f * ctx->vf.cell_size;
     ctx->cam.position.z = ctx->vf.origin_z + gy_center_f * ctx->vf.cell_size;
     ctx->cam.position.y = ctx->vf.extrude_h + ctx->cam_half_height + 0.1f;
+    ctx->cam_prev_pos = ctx->cam.position;
 
     float dx = -ctx->cam.position.x;
     float dz = -ctx->cam.position.z;
@@ -13,16 +13,28 @@ extern "C" {
 #endif
 
 #include "ttfe_game_context.h"
+#include "ttfe_loading.h"
 #include <allegro5/allegro_font.h>
 #include <allegro5/allegro_ttf.h>
 
 /* LEVEL BUILDING */
 
+/* text bitmap pixels per voxel cell */
+#define LEVEL_VOXEL_STEP 4
+/* world size of a voxel cell */
+#define LEVEL_CELL_SIZE 3.0f
+/* height of the extruded letters */
+#define LEVEL_EXTRUDE_H 40.0f
+
 typedef struct {
     int gx, gy;
 } WalkCell;
 
-/* build a level from a font */
+/* rasterize the phrase and fill vf from it. Needs the display thread (font + bitmap) */
+int build_level_voxels(VoxelField* vf, ALLEGRO_FONT* level_font, LoadingProgress* progress, const char* phrase, int phrase_len, int level_font_size);
+/* build the greedy level mesh and overlays from vf. Touches no Allegro state, safe on a worker thread */
+int build_level_meshes(const VoxelField* vf, VertexArray* va_level, VertexArray* va_letters, VertexArray* va_goals, LoadingProgress* progress);
+/* build a level from a font: level cache, else build_level_voxels + build_level_meshes into ctx (and cache it) */
 int build_level_geometry(GameContext* ctx, ALLEGRO_FONT* level_font, ALLEGRO_FONT* gui_font, const char* phrase, int phrase_len, int level_font_size);
 /* place bonus boxes and 'lights' */
 void place_boxes_and_lights(GameContext* ctx);
@@ -0,0 +1,303 @@
+/**\file ttfe_level_cache.c
+ *  on-disk cache of built levels (voxel field + vertex arrays)
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "ttfe_level_cache.h"
+#include "ttfe_level.h"
+#include "nilorea/n_log.h"
+
+/* sections start on 16 bytes boundaries */
+#define CACHE_ALIGN(x) (((size_t)(x) + 15) & ~(size_t)15)
+
+typedef struct {
+    char magic[4]; /* "TTFL" */
+    uint32_t version;
+    uint64_t key;
+    int32_t gw, gh;
+    float cell_size, extrude_h;
+    float origin_x, origin_z;
+    int32_t vertex_count[3]; /* level, letters, goals */
+    int32_t index_count[3];
+    uint32_t cell_bytes;   /* sizeof(*cells) */
+    uint32_t vertex_bytes; /* sizeof(ALLEGRO_VERTEX) */
+} LevelCacheHeader;
+
+/* FNV-1a 64 */
+static uint64_t hash_bytes(uint64_t h, const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static void cache_path(const LevelCache* cache, uint64_t key, const char* ext, char* path, size_t size) {
+    snprintf(path, size, "%s/%016llx.%s", cache->dir, (unsigned long long)key, ext);
+}
+
+/* read only view of a whole file */
+static const unsigned char* map_file(const char* path, size_t* size) {
+#if defined(_WIN32) || defined(__EMSCRIPTEN__)
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char* data = len > 0 ? (unsigned char*)malloc((size_t)len) : NULL;
+    if (data && fread(data, 1, (size_t)len, f) != (size_t)len) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *size = (size_t)len;
+    return data;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    void* data = NULL;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) data = NULL;
+        *size = (size_t)st.st_size;
+    }
+    close(fd);
+    return (const unsigned char*)data;
+#endif
+}
+
+static void unmap_file(const unsigned char* data, size_t size) {
+#if defined(_WIN32) || defined(__EMSCRIPTEN__)
+    (void)size;
+    free((void*)data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
+/* write a section and pad it to the next boundary */
+static bool write_section(FILE* f, const void* data, size_t size) {
+    static const unsigned char zeros[16] = {0};
+    if (size > 0 && fwrite(data, 1, size, f) != size) return false;
+    size_t pad = CACHE_ALIGN(size) - size;
+    return pad == 0 || fwrite(zeros, 1, pad, f) == pad;
+}
+
+/* init the cache in dir for the given level font. Leaves it disabled if the font can't be read */
+bool level_cache_init(LevelCache* cache, const char* dir, const char* font_file) {
+    memset(cache, 0, sizeof(LevelCache));
+
+#ifdef __EMSCRIPTEN__
+    /* the wasm file system is rebuilt on each load, nothing to gain */
+    (void)dir;
+    (void)font_file;
+    return false;
+#else
+    FILE* f = fopen(font_file, "rb");
+    if (!f) {
+        n_log(LOG_ERR, "level cache disabled, unable to read %s", font_file);
+        return false;
+    }
+    uint64_t h = 0xcbf29ce484222325ULL;
+    unsigned char buf[16384];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), f)) > 0) h = hash_bytes(h, buf, len);
+    fclose(f);
+
+#if defined(_WIN32)
+    int rc = _mkdir(dir);
+#else
+    int rc = mkdir(dir, 0755);
+#endif
+    if (rc != 0 && errno != EEXIST) {
+        n_log(LOG_ERR, "level cache disabled, unable to create %s", dir);
+        return false;
+    }
+
+    snprintf(cache->dir, sizeof(cache->dir), "%s", dir);
+    cache->font_hash = h;
+    cache->enabled = true;
+    return true;
+#endif
+}
+
+/* key of a level */
+uint64_t level_cache_key(const LevelCache* cache, const char* phrase, int level_font_size) {
+    int32_t params[3] = {LEVEL_CACHE_VERSION, level_font_size, LEVEL_VOXEL_STEP};
+    float sizes[2] = {LEVEL_CELL_SIZE, LEVEL_EXTRUDE_H};
+
+    uint64_t h = hash_bytes(0xcbf29ce484222325ULL, &cache->font_hash, sizeof(cache->font_hash));
+    h = hash_bytes(h, params, sizeof(params));
+    h = hash_bytes(h, sizes, sizeof(sizes));
+    return hash_bytes(h, phrase, strlen(phrase));
+}
+
+/* quads only (6 indices each), all within the vertices: the level chunks read the vertices on the CPU */
+static bool cache_indices_valid(const int* indices, int index_count, int vertex_count) {
+    if (index_count % 6 != 0) return false;
+    for (int i = 0; i < index_count; i++) {
+        if (indices[i] < 0 || indices[i] >= vertex_count) return false;
+    }
+    return true;
+}
+
+/* true if a cache file exists for key (not validated) */
+bool level_cache_contains(const LevelCache* cache, uint64_t key) {
+    if (!cache->enabled) return false;
+
+    char path[600];
+    struct stat st;
+    cache_path(cache, key, "lvl", path, sizeof(path));
+    return stat(path, &st) == 0;
+}
+
+/* load a cached level into vf and the arrays. vf arrays are allocated, the vertex arrays are overwritten. Returns false on miss */
+bool level_cache_load(const LevelCache* cache, uint64_t key, VoxelField* vf, VertexArray* va_level, VertexArray* va_letters, VertexArray* va_goals) {
+    if (!cache->enabled) return false;
+
+    char path[600];
+    cache_path(cache, key, "lvl", path, sizeof(path));
+    size_t size = 0;
+    const unsigned char* data = map_file(path, &size);
+    if (!data) return false;
+
+    LevelCacheHeader hdr;
+    VertexArray* arrays[3] = {va_level, va_letters, va_goals};
+    bool ok = size >= sizeof(hdr);
+    if (ok) {
+        memcpy(&hdr, data, sizeof(hdr));
+        ok = !memcmp(hdr.magic, "TTFL", 4) && hdr.version == LEVEL_CACHE_VERSION && hdr.key == key &&
+             hdr.cell_bytes == sizeof(*vf->cells) && hdr.vertex_bytes == sizeof(ALLEGRO_VERTEX) &&
+             hdr.gw > 0 && hdr.gh > 0 && hdr.gw <= 65536 && hdr.gh <= 65536;
+    }
+
+    /* the size has to match the header exactly */
+    size_t cells_size = 0;
+    if (ok) {
+        cells_size = CACHE_ALIGN((size_t)hdr.gw * hdr.gh * hdr.cell_bytes);
+        size_t expected = CACHE_ALIGN(sizeof(hdr)) + cells_size;
+        for (int a = 0; a < 3 && ok; a++) {
+            ok = hdr.vertex_count[a] >= 0 && hdr.index_count[a] >= 0;
+            expected += CACHE_ALIGN((size_t)hdr.vertex_count[a] * sizeof(ALLEGRO_VERTEX)) + CACHE_ALIGN((size_t)hdr.index_count[a] * sizeof(int));
+        }
+        ok = ok && expected == size;
+    }
+
+    /* then the indices, before anything is copied */
+    if (ok) {
+        const unsigned char* p = data + CACHE_ALIGN(sizeof(hdr)) + cells_size;
+        for (int a = 0; a < 3 && ok; a++) {
+            p += CACHE_ALIGN((size_t)hdr.vertex_count[a] * sizeof(ALLEGRO_VERTEX));
+            ok = cache_indices_valid((const int*)p, hdr.index_count[a], hdr.vertex_count[a]);
+            p += CACHE_ALIGN((size_t)hdr.index_count[a] * sizeof(int));
+        }
+    }
+    if (!ok) {
+        n_log(LOG_ERR, "ignoring stale or damaged level cache %s", path);
+        unmap_file(data, size);
+        return false;
+    }
+
+    const unsigned char* p = data + CACHE_ALIGN(sizeof(hdr));
+    size_t cells = (size_t)hdr.gw * hdr.gh;
+    vf->gw = hdr.gw;
+    vf->gh = hdr.gh;
+    vf->cell_size = hdr.cell_size;
+    vf->extrude_h = hdr.extrude_h;
+    vf->origin_x = hdr.origin_x;
+    vf->origin_z = hdr.origin_z;
+    if (!voxel_field_alloc(vf)) {
+        unmap_file(data, size);
+        return false;
+    }
+    memcpy(vf->cells, p, cells * sizeof(*vf->cells));
+    p += cells_size;
+
+    for (int a = 0; a < 3; a++) {
+        VertexArray* va = arrays[a];
+        va_clear(va);
+        va_reserve(va, hdr.vertex_count[a]);
+        memcpy(va->v, p, (size_t)hdr.vertex_count[a] * sizeof(ALLEGRO_VERTEX));
+        va->count = hdr.vertex_count[a];
+        p += CACHE_ALIGN((size_t)hdr.vertex_count[a] * sizeof(ALLEGRO_VERTEX));
+
+        va_reserve_indices(va, hdr.index_count[a]);
+        memcpy(va->indices, p, (size_t)hdr.index_count[a] * sizeof(int));
+        va->index_count = hdr.index_count[a];
+        p += CACHE_ALIGN((size_t)hdr.index_count[a] * sizeof(int));
+    }
+
+    unmap_file(data, size);
+    return true;
+}
+
+/* write a built level to the cache */
+bool level_cache_store(const LevelCache* cache, uint64_t key, const VoxelField* vf, const VertexArray* va_level, const VertexArray* va_letters, const VertexArray* va_goals) {
+    if (!cache->enabled) return false;
+
+    const VertexArray* arrays[3] = {va_level, va_letters, va_goals};
+    LevelCacheHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, "TTFL", 4);
+    hdr.version = LEVEL_CACHE_VERSION;
+    hdr.key = key;
+    hdr.gw = vf->gw;
+    hdr.gh = vf->gh;
+    hdr.cell_size = vf->cell_size;
+    hdr.extrude_h = vf->extrude_h;
+    hdr.origin_x = vf->origin_x;
+    hdr.origin_z = vf->origin_z;
+    for (int a = 0; a < 3; a++) {
+        hdr.vertex_count[a] = arrays[a]->count;
+        hdr.index_count[a] = arrays[a]->index_count;
+    }
+    hdr.cell_bytes = sizeof(*vf->cells);
+    hdr.vertex_bytes = sizeof(ALLEGRO_VERTEX);
+
+    /* written aside then renamed, so a reader never maps a partial file */
+    char tmp_path[600], path[600];
+    cache_path(cache, key, "tmp", tmp_path, sizeof(tmp_path));
+    cache_path(cache, key, "lvl", path, sizeof(path));
+
+    FILE* f = fopen(tmp_path, "wb");
+    if (!f) {
+        n_log(LOG_ERR, "unable to write level cache %s", tmp_path);
+        return false;
+    }
+    size_t cells = (size_t)vf->gw * vf->gh;
+    bool ok = write_section(f, &hdr, sizeof(hdr)) &&
+              write_section(f, vf->cells, cells * sizeof(*vf->cells));
+    for (int a = 0; a < 3 && ok; a++) {
+        ok = write_section(f, arrays[a]->v, (size_t)arrays[a]->count * sizeof(ALLEGRO_VERTEX)) &&
+             write_section(f, arrays[a]->indices, (size_t)arrays[a]->index_count * sizeof(int));
+    }
+    ok = (fclose(f) == 0) && ok;
+
+#if defined(_WIN32)
+    remove(path); /* rename doesn't replace on windows */
+#endif
+    if (!ok || rename(tmp_path, path) != 0) {
+        n_log(LOG_ERR, "unable to write level cache %s", path);
+        remove(tmp_path);
+        return false;
+    }
+    return true;
+}
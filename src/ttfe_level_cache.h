@@ -0,0 +1,50 @@
+/**\file ttfe_level_cache.h
+ *  on-disk cache of built levels (voxel field + vertex arrays)
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#ifndef TTFE_LEVEL_CACHE_HEADER_FOR_HACKS
+#define TTFE_LEVEL_CACHE_HEADER_FOR_HACKS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "ttfe_vector3d.h"
+
+/* bump when the file layout or the level builder output changes */
+#define LEVEL_CACHE_VERSION 3
+
+/*
+ * One file per level, named after a hash of the phrase, the level font
+ * file contents, the font size and the voxel constants. A file is a
+ * fixed header followed by 16 bytes aligned raw sections (voxel cells,
+ * then vertices and indices of the level, letters and goals arrays), so
+ * it can be mapped and used as is.
+ */
+typedef struct {
+    bool enabled;
+    char dir[512];      /* cache directory */
+    uint64_t font_hash; /* hash of the level font file contents */
+} LevelCache;
+
+/* init the cache in dir for the given level font. Leaves it disabled if the font can't be read */
+bool level_cache_init(LevelCache* cache, const char* dir, const char* font_file);
+/* key of a level */
+uint64_t level_cache_key(const LevelCache* cache, const char* phrase, int level_font_size);
+/* true if a cache file exists for key (not validated) */
+bool level_cache_contains(const LevelCache* cache, uint64_t key);
+/* load a cached level into vf and the arrays. vf arrays are allocated, the vertex arrays are overwritten. Returns false on miss */
+bool level_cache_load(const LevelCache* cache, uint64_t key, VoxelField* vf, VertexArray* va_level, VertexArray* va_letters, VertexArray* va_goals);
+/* write a built level to the cache */
+bool level_cache_store(const LevelCache* cache, uint64_t key, const VoxelField* vf, const VertexArray* va_level, const VertexArray* va_letters, const VertexArray* va_goals);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+/**\file ttfe_level_chunks.c
+ *  level meshes split in square chunks of cells, each with its bounding box, for frustum culling
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#include "ttfe_level_chunks.h"
+#include "nilorea/n_log.h"
+
+/* sort the quads of va (6 indices each) by chunk and compute the chunk bounds. Must run before uploading va */
+bool level_chunks_build(LevelChunks* lc, const VoxelField* vf, VertexArray* va) {
+    level_chunks_free(lc);
+
+    int cw = (vf->gw + LEVEL_CHUNK_CELLS - 1) / LEVEL_CHUNK_CELLS;
+    int ch = (vf->gh + LEVEL_CHUNK_CELLS - 1) / LEVEL_CHUNK_CELLS;
+    if (cw < 1) cw = 1;
+    if (ch < 1) ch = 1;
+
+    int quads = va->index_count / 6;
+    lc->chunks = (LevelChunk*)calloc((size_t)cw * ch, sizeof(LevelChunk));
+    int* quad_chunk = (int*)malloc(sizeof(int) * (quads > 0 ? quads : 1));
+    int* sorted = (int*)malloc(sizeof(int) * (va->index_count > 0 ? va->index_count : 1));
+    if (!lc->chunks || !quad_chunk || !sorted) {
+        n_log(LOG_ERR, "Failed to allocate %dx%d level chunks", cw, ch);
+        free(quad_chunk);
+        free(sorted);
+        level_chunks_free(lc);
+        return false;
+    }
+    lc->cw = cw;
+    lc->ch = ch;
+
+    /* chunk and bounds of each quad, from its center */
+    for (int q = 0; q < quads; q++) {
+        const int* idx = va->indices + q * 6;
+        Vec3 qmin = {FLT_MAX, FLT_MAX, FLT_MAX};
+        Vec3 qmax = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+        for (int k = 0; k < 6; k++) {
+            const ALLEGRO_VERTEX* v = &va->v[idx[k]];
+            qmin = v_make(fminf(qmin.x, v->x), fminf(qmin.y, v->y), fminf(qmin.z, v->z));
+            qmax = v_make(fmaxf(qmax.x, v->x), fmaxf(qmax.y, v->y), fmaxf(qmax.z, v->z));
+        }
+
+        int gx, gy;
+        world_to_grid(vf, (qmin.x + qmax.x) * 0.5f, (qmin.z + qmax.z) * 0.5f, &gx, &gy);
+        int cx = gx / LEVEL_CHUNK_CELLS;
+        int cy = gy / LEVEL_CHUNK_CELLS;
+        if (cx < 0) cx = 0;
+        if (cx >= cw) cx = cw - 1;
+        if (cy < 0) cy = 0;
+        if (cy >= ch) cy = ch - 1;
+
+        LevelChunk* c = &lc->chunks[cy * cw + cx];
+        if (c->index_count == 0) {
+            c->min = qmin;
+            c->max = qmax;
+        } else {
+            c->min = v_make(fminf(c->min.x, qmin.x), fminf(c->min.y, qmin.y), fminf(c->min.z, qmin.z));
+            c->max = v_make(fmaxf(c->max.x, qmax.x), fmaxf(c->max.y, qmax.y), fmaxf(c->max.z, qmax.z));
+        }
+        c->index_count += 6;
+        quad_chunk[q] = cy * cw + cx;
+    }
+
+    /* counting sort of the quads by chunk */
+    int first = 0;
+    for (int i = 0; i < cw * ch; i++) {
+        lc->chunks[i].first_index = first;
+        first += lc->chunks[i].index_count;
+        lc->chunks[i].index_count = 0;
+    }
+    for (int q = 0; q < quads; q++) {
+        LevelChunk* c = &lc->chunks[quad_chunk[q]];
+        memcpy(sorted + c->first_index + c->index_count, va->indices + q * 6, sizeof(int) * 6);
+        c->index_count += 6;
+    }
+    memcpy(va->indices, sorted, sizeof(int) * quads * 6);
+
+    free(quad_chunk);
+    free(sorted);
+    return true;
+}
+
+/* free the chunk table */
+void level_chunks_free(LevelChunks* lc) {
+    free(lc->chunks);
+    lc->chunks = NULL;
+    lc->cw = lc->ch = 0;
+}
+
+/* draw a range of indices from the static buffer, else from the VertexArray */
+static void level_chunks_draw_range(const TTFE_VBO* vbo, const VertexArray* va, ALLEGRO_BITMAP* texture, int first, int count, int prim_type) {
+    if (count <= 0) return;
+    if (vbo && vbo->vb && vbo->ib) {
+        ttfe_vbo_draw_static_range(vbo, texture, first, count, prim_type);
+    } else if (va && va->index_count >= first + count) {
+        al_draw_indexed_prim(va->v, NULL, texture, va->indices + first, count, prim_type);
+        ttfe_vbo_count_draw(count);
+    }
+}
+
+/* draw the chunks of va in the frustum, from the static vbo if any. Returns the number of visible chunks */
+int level_chunks_draw(const LevelChunks* lc, const Frustum* frustum, const TTFE_VBO* vbo, const VertexArray* va, ALLEGRO_BITMAP* texture, int prim_type) {
+    if (!lc->chunks) {
+        /* no chunks: the whole mesh */
+        level_chunks_draw_range(vbo, va, texture, 0, va ? va->index_count : 0, prim_type);
+        return 0;
+    }
+
+    /* consecutive visible chunks are consecutive in the indices: one draw per run */
+    int visible = 0;
+    int run_first = 0, run_count = 0;
+    for (int i = 0; i < lc->cw * lc->ch; i++) {
+        const LevelChunk* c = &lc->chunks[i];
+        if (c->index_count == 0) continue;
+
+        if (!frustum || frustum_aabb_visible(frustum, c->min, c->max)) {
+            if (run_count == 0) run_first = c->first_index;
+            run_count += c->index_count;
+            visible++;
+            continue;
+        }
+        level_chunks_draw_range(vbo, va, texture, run_first, run_count, prim_type);
+        run_count = 0;
+    }
+    level_chunks_draw_range(vbo, va, texture, run_first, run_count, prim_type);
+    return visible;
+}
@@ -0,0 +1,48 @@
+/**\file ttfe_level_chunks.h
+ *  level meshes split in square chunks of cells, each with its bounding box, for frustum culling
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#ifndef TTFE_LEVEL_CHUNKS_HEADER_FOR_HACKS
+#define TTFE_LEVEL_CHUNKS_HEADER_FOR_HACKS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ttfe_vector3d.h"
+#include "ttfe_vbo.h"
+
+/* chunk side, in voxel cells. The level mesher doesn't merge faces across chunk borders */
+#define LEVEL_CHUNK_CELLS 32
+
+typedef struct {
+    Vec3 min, max;   /* bounds of the chunk faces */
+    int first_index; /* start of the chunk faces in the mesh indices */
+    int index_count; /* 0 for an empty chunk */
+} LevelChunk;
+
+/*
+ * Chunks of one quad mesh built over a VoxelField. level_chunks_build sorts
+ * the mesh quads by chunk, so each chunk is a contiguous index range and
+ * runs of visible chunks are drawn with a single call.
+ */
+typedef struct {
+    LevelChunk* chunks; /* cw * ch, row major along x */
+    int cw, ch;
+} LevelChunks;
+
+/* sort the quads of va (6 indices each) by chunk and compute the chunk bounds. Must run before uploading va */
+bool level_chunks_build(LevelChunks* lc, const VoxelField* vf, VertexArray* va);
+/* free the chunk table */
+void level_chunks_free(LevelChunks* lc);
+/* draw the chunks of va in the frustum, from the static vbo if any. Returns the number of visible chunks */
+int level_chunks_draw(const LevelChunks* lc, const Frustum* frustum, const TTFE_VBO* vbo, const VertexArray* va, ALLEGRO_BITMAP* texture, int prim_type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
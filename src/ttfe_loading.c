@@ -80,3 +80,36 @@ void draw_text_box_with_progress(
 
     al_flip_display();
 }
+
+/* init a progress reporter with the default loading box colors */
+void loading_progress_init(LoadingProgress* lp, ALLEGRO_FONT* font, float x, float y, double min_interval) {
+    lp->font = font;
+    lp->x = x;
+    lp->y = y;
+    lp->text_color = al_map_rgb(255, 255, 255);
+    lp->bg_color = al_map_rgba(20, 20, 20, 220);
+    lp->border_color = al_map_rgb(255, 255, 255);
+    lp->bar_color = al_map_rgb(80, 200, 120);
+    lp->min_interval = min_interval;
+    lp->last_draw = 0.0;
+    lp->last_sentence = NULL;
+}
+
+/* report progress, redraws only on a new sentence, on the last step or once min_interval elapsed. Returns true if it redrew */
+bool loading_progress_report(LoadingProgress* lp, const char* sentence, int start_value, int end_value, int current_value) {
+    if (!lp) return false;
+
+    double now = al_get_time();
+    bool new_step = (sentence != lp->last_sentence);
+    bool last_step = (current_value >= end_value - 1);
+
+    if (!new_step && !last_step && now - lp->last_draw < lp->min_interval)
+        return false;
+
+    draw_text_box_with_progress(sentence, lp->font, lp->x, lp->y,
+                                lp->text_color, lp->bg_color, lp->border_color, lp->bar_color,
+                                start_value, end_value, current_value);
+    lp->last_draw = now;
+    lp->last_sentence = sentence;
+    return true;
+}
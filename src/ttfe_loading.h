@@ -40,6 +40,31 @@ void draw_text_box_with_progress(
     int end_value,
     int current_value);
 
+/* minimum delay between two progress redraws, in seconds */
+#define LOADING_PROGRESS_INTERVAL (1.0 / 60.0)
+
+/*
+ * Rate limited progress reporter around draw_text_box_with_progress,
+ * so long build loops can report every step without waiting on
+ * al_flip_display (and vsync) each time.
+ */
+typedef struct {
+    ALLEGRO_FONT* font;
+    float x, y;
+    ALLEGRO_COLOR text_color;
+    ALLEGRO_COLOR bg_color;
+    ALLEGRO_COLOR border_color;
+    ALLEGRO_COLOR bar_color;
+    double min_interval;       /* minimum delay between two redraws */
+    double last_draw;          /* al_get_time() of the last redraw */
+    const char* last_sentence; /* sentence of the last redraw */
+} LoadingProgress;
+
+/* init a progress reporter with the default loading box colors */
+void loading_progress_init(LoadingProgress* lp, ALLEGRO_FONT* font, float x, float y, double min_interval);
+/* report progress, redraws only on a new sentence, on the last step or once min_interval elapsed. Returns true if it redrew. lp may be NULL (silent build) */
+bool loading_progress_report(LoadingProgress* lp, const char* sentence, int start_value, int end_value, int current_value);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,401 @@
+/**\file ttfe_microbench.c
+ *  micro-benchmarks of the core kernels, JSON or CSV output, fixed seeds
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+#include <allegro5/allegro_ttf.h>
+
+#include "cJSON.h"
+#include "nilorea/n_common.h"
+#include "nilorea/n_log.h"
+#include "nilorea/n_str.h"
+#include "ttfe_app_config.h"
+#include "ttfe_game_context.h"
+#include "ttfe_particles.h"
+#include "ttfe_stars.h"
+#include "ttfe_level.h"
+#include "ttfe_text.h"
+
+/* fixed inputs, so results can be compared between releases */
+#define MICROBENCH_PHRASE "KrampusHack2025"
+#define MICROBENCH_LEVEL_LINE "KrampusHack2025 1 1 0"
+#define MICROBENCH_CONFIG "DATA/app_config.json"
+#define MICROBENCH_RUNS 7
+#define MICROBENCH_POINTS 65536
+#define MICROBENCH_TICKS 60
+
+/* everything the benchmarks work on, prepared once */
+typedef struct {
+    unsigned int seed;
+    ALLEGRO_FONT* level_font;
+    int level_font_size;
+    float bullet_speed;
+    GameContext ctx; /* bench level voxels and pools */
+    Vec3* points;    /* MICROBENCH_POINTS random positions over the level */
+    Vec3* box_points;
+    EntityPool alloc_pool;
+    char* config_text;
+    volatile int sink; /* keeps the results alive */
+} MicroBenchData;
+
+typedef struct {
+    const char* name;
+    int ops;                            /* operations per run */
+    void (*prepare)(MicroBenchData* d); /* untimed, before each run, may be NULL */
+    void (*run)(MicroBenchData* d);
+} MicroBench;
+
+int getoptret = 0;
+int log_level = LOG_ERR;
+
+void usage(int log_level, char* progname) {
+    n_log(log_level,
+          "\n    %s usage:\n"
+          "    -h => print help\n"
+          "    -V LOGLEVEL => choose log level\n"
+          "    -F json|csv => output format (default json)\n"
+          "    -s seed => random seed (default 1)\n"
+          "    -f level_font_file\n",
+          progname);
+}
+
+/* voxelize */
+static void run_voxelize(MicroBenchData* d) {
+    VoxelField vf;
+    memset(&vf, 0, sizeof(VoxelField));
+    d->sink += build_level_voxels(&vf, d->level_font, NULL, MICROBENCH_PHRASE, (int)strlen(MICROBENCH_PHRASE), d->level_font_size);
+    voxel_field_free(&vf);
+}
+
+/* greedy meshes */
+static void run_mesh(MicroBenchData* d) {
+    d->sink += build_level_meshes(&d->ctx.vf, &d->ctx.va_level, &d->ctx.va_overlay_letters, &d->ctx.va_overlay_goals, NULL);
+}
+
+/* capsule vs voxels */
+static void run_capsule_collides(MicroBenchData* d) {
+    int hits = 0;
+    for (int i = 0; i < MICROBENCH_POINTS; i++)
+        hits += capsule_collides(&d->ctx.vf, d->points[i], d->ctx.cam_radius, d->ctx.cam_half_height);
+    d->sink += hits;
+}
+
+/* capsule vs box */
+static void run_capsule_aabb_collides(MicroBenchData* d) {
+    int hits = 0;
+    for (int i = 0; i < MICROBENCH_POINTS; i++)
+        hits += capsule_aabb_collides(d->points[i], d->ctx.cam_radius, d->ctx.cam_half_height, d->box_points[i], 4.0f);
+    d->sink += hits;
+}
+
+/* boxes, lights and a full load of projectiles fired around the start position */
+static void prepare_projectiles(MicroBenchData* d) {
+    game_context_reset_level(&d->ctx);
+    place_boxes_and_lights(&d->ctx);
+    setup_camera_start(&d->ctx);
+    float yaw = d->ctx.cam.yaw;
+    for (int i = 0; i < MAX_PROJECTILES; i++) {
+        d->ctx.cam.yaw = yaw + frandf(-0.8f, 0.8f);
+        d->ctx.cam.pitch = frandf(-0.3f, 0.1f);
+        fire_projectile(&d->ctx, NULL, false, d->bullet_speed);
+    }
+    d->ctx.cam.yaw = yaw;
+    d->ctx.cam.pitch = 0.0f;
+}
+
+static void run_update_projectiles(MicroBenchData* d) {
+    int boxes_hit = 0, time_bonus = 0, speed_bonus = 0;
+    for (int i = 0; i < MICROBENCH_TICKS; i++)
+        update_projectiles(&d->ctx, 1.0f / 120.0f, NULL, NULL, false, &boxes_hit, &time_bonus, &speed_bonus, 0.2f, 3.0f);
+    d->sink += boxes_hit;
+}
+
+/* a full particle pool */
+static void prepare_particles(MicroBenchData* d) {
+    particle_pool_clear(&d->ctx.particles);
+    for (int i = 0; i < MAX_PARTICLES; i++) {
+        particle_pool_spawn(&d->ctx.particles,
+                            v_make(frandf(-100.0f, 100.0f), frandf(0.0f, 60.0f), frandf(-100.0f, 100.0f)),
+                            v_make(frandf(-10.0f, 10.0f), frandf(5.0f, 15.0f), frandf(-10.0f, 10.0f)),
+                            frandf(0.5f, 1.5f), 0.5f, al_map_rgb(255, 255, 255));
+    }
+}
+
+static void run_update_particles(MicroBenchData* d) {
+    for (int i = 0; i < MICROBENCH_TICKS; i++)
+        update_particles(&d->ctx, -70.0f, 1.0f / 120.0f);
+    d->sink += d->ctx.particles.count;
+}
+
+/* intro snow over a 1200x800 screen */
+static void prepare_intro_snow(MicroBenchData* d) {
+    d->ctx.dw = 1200;
+    d->ctx.dh = 800;
+    spawn_intro_snow(&d->ctx);
+}
+
+static void run_update_intro_snow(MicroBenchData* d) {
+    for (int i = 0; i < MICROBENCH_TICKS; i++)
+        update_intro_snow(&d->ctx, 1.0f / 120.0f);
+    d->sink += d->ctx.intro_snow.count;
+}
+
+/* snow flakes vertices */
+static void run_build_snow_batch(MicroBenchData* d) {
+    particle_batch_set_template(&d->ctx.batch_2d, 8, 0.0f);
+    particle_batch_build(&d->ctx.batch_2d, &d->ctx.intro_snow);
+    d->sink += d->ctx.batch_2d.va.count;
+}
+
+/* starfield baked from the level stars */
+static void prepare_starfield(MicroBenchData* d) {
+    starfield_mesh_build(&d->ctx.starfield, &d->ctx.stars);
+}
+
+/* CPU path twinkle of the baked starfield */
+static void run_starfield_twinkle(MicroBenchData* d) {
+    starfield_mesh_twinkle(&d->ctx.starfield, 1.0f);
+    d->sink += d->ctx.starfield.star_count;
+}
+
+/* pink lights all over the level */
+static void prepare_pink_lights(MicroBenchData* d) {
+    pool_clear(&d->ctx.pink_lights);
+    for (int i = 0; i < PINK_LIGHT_MAX; i++) {
+        GameEntity* light = pool_alloc(&d->ctx.pink_lights);
+        if (light)
+            entity_init_pink_light(light, d->points[i], frandf(1.0f, 3.0f));
+    }
+}
+
+/* pink light billboards */
+static void run_render_pink_lights(MicroBenchData* d) {
+    render_pink_lights(&d->ctx.pink_lights, &d->ctx.va_pink_lights, NULL, v_make(1.0f, 0.0f, 0.0f), v_make(0.0f, 1.0f, 0.0f), 1.0f, 1.0f);
+    d->sink += d->ctx.va_pink_lights.count;
+}
+
+/* empty pool */
+static void prepare_pool_alloc(MicroBenchData* d) {
+    pool_clear(&d->alloc_pool);
+}
+
+static void run_pool_alloc(MicroBenchData* d) {
+    for (int i = 0; i < STAR_COUNT; i++)
+        d->sink += pool_alloc(&d->alloc_pool) != NULL;
+}
+
+/* level line split */
+static void run_split(MicroBenchData* d) {
+    for (int i = 0; i < 1000; i++) {
+        char** tokens = split(MICROBENCH_LEVEL_LINE, " ", 0);
+        d->sink += split_count(tokens);
+        free_split_result(&tokens);
+    }
+}
+
+/* level line split in place, on a stack copy like a line of the levels mapping */
+static void run_text_span_tokens(MicroBenchData* d) {
+    for (int i = 0; i < 1000; i++) {
+        char line[] = MICROBENCH_LEVEL_LINE;
+        TextSpan span = {line, sizeof(line) - 1};
+        TextSpan tokens[LEVEL_LINE_TOKENS];
+        d->sink += text_span_tokens(span, tokens, LEVEL_LINE_TOKENS);
+    }
+}
+
+/* app config parse */
+static void run_cjson_parse(MicroBenchData* d) {
+    for (int i = 0; i < 1000; i++) {
+        cJSON* json = cJSON_Parse(d->config_text);
+        d->sink += json != NULL;
+        cJSON_Delete(json);
+    }
+}
+
+static const MicroBench microbenches[] = {
+    {"voxelize", 1, NULL, run_voxelize},
+    {"mesh", 1, NULL, run_mesh},
+    {"capsule_collides", MICROBENCH_POINTS, NULL, run_capsule_collides},
+    {"capsule_aabb_collides", MICROBENCH_POINTS, NULL, run_capsule_aabb_collides},
+    {"update_projectiles", MICROBENCH_TICKS, prepare_projectiles, run_update_projectiles},
+    {"update_particles", MICROBENCH_TICKS, prepare_particles, run_update_particles},
+    {"update_intro_snow", MICROBENCH_TICKS, prepare_intro_snow, run_update_intro_snow},
+    {"build_snow_batch", 1, prepare_intro_snow, run_build_snow_batch},
+    {"starfield_twinkle", 1, prepare_starfield, run_starfield_twinkle},
+    {"render_pink_lights", 1, prepare_pink_lights, run_render_pink_lights},
+    {"pool_alloc", STAR_COUNT, prepare_pool_alloc, run_pool_alloc},
+    {"split", 1000, NULL, run_split},
+    {"text_span_tokens", 1000, NULL, run_text_span_tokens},
+    {"cjson_parse", 1000, NULL, run_cjson_parse}};
+
+#define MICROBENCH_COUNT (int)(sizeof(microbenches) / sizeof(microbenches[0]))
+
+static int compare_double(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+/* read a whole text file, NULL on error */
+static char* read_text_file(const char* filename) {
+    FILE* in = fopen(filename, "rb");
+    if (!in) return NULL;
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    char* text = (size >= 0) ? (char*)malloc((size_t)size + 1) : NULL;
+    if (text) {
+        size_t got = fread(text, 1, (size_t)size, in);
+        text[got] = '\0';
+    }
+    fclose(in);
+    return text;
+}
+
+int main(int argc, char** argv) {
+    set_log_level(LOG_ERR);
+
+    bool csv = false;
+    unsigned int seed = 1;
+    const char* override_level_font_file = NULL;
+
+    while ((getoptret = getopt(argc, argv, "hV:F:s:f:")) != EOF) {
+        switch (getoptret) {
+            case 'h':
+                usage(LOG_INFO, argv[0]);
+                exit(0);
+            case 'V':
+                if ((log_level = app_config_log_level(optarg)) < 0)
+                    exit(FALSE);
+                set_log_level(log_level);
+                break;
+            case 'F':
+                if (!strcmp(optarg, "csv"))
+                    csv = true;
+                else if (strcmp(optarg, "json")) {
+                    n_log(LOG_ERR, "%s is not a valid output format", optarg);
+                    exit(FALSE);
+                }
+                break;
+            case 's':
+                seed = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'f':
+                override_level_font_file = optarg;
+                break;
+            default:
+                usage(LOG_ERR, argv[0]);
+                exit(FALSE);
+        }
+    }
+
+    /* same config as the game */
+    AppConfig config;
+    if (app_config_load(&config, MICROBENCH_CONFIG, override_level_font_file, NULL, NULL) != TRUE) {
+        exit(1);
+    }
+
+    /* no display: fonts and the text bitmaps are memory bitmaps */
+    if (!al_init()) {
+        fprintf(stderr, "al_init() failed\n");
+        return FALSE;
+    }
+    al_init_font_addon();
+    al_init_ttf_addon();
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP);
+
+    MicroBenchData d;
+    memset(&d, 0, sizeof(MicroBenchData));
+    d.seed = seed;
+    d.level_font_size = config.level_font_size;
+    d.bullet_speed = config.bullet_speed;
+    d.level_font = al_load_ttf_font(config.level_font_file, config.level_font_size, 0);
+    d.config_text = read_text_file(MICROBENCH_CONFIG);
+    if (!d.level_font || !d.config_text) {
+        n_log(LOG_ERR, "unable to load %s or %s", config.level_font_file, MICROBENCH_CONFIG);
+        return FALSE;
+    }
+
+    /* shared level and inputs */
+    game_context_init(&d.ctx, config.base_speed);
+    d.ctx.dw = (int)config.width;
+    d.ctx.dh = (int)config.height;
+    d.ctx.level_count = 1;
+    if (!build_level_voxels(&d.ctx.vf, d.level_font, NULL, MICROBENCH_PHRASE, (int)strlen(MICROBENCH_PHRASE), config.level_font_size) ||
+        !box_grid_setup(&d.ctx.box_grid, &d.ctx.vf)) {
+        n_log(LOG_ERR, "unable to build the bench level");
+        return FALSE;
+    }
+    voxel_field_build_distance(&d.ctx.vf);
+
+    srand(seed);
+    const VoxelField* vf = &d.ctx.vf;
+    d.points = (Vec3*)malloc(sizeof(Vec3) * MICROBENCH_POINTS);
+    d.box_points = (Vec3*)malloc(sizeof(Vec3) * MICROBENCH_POINTS);
+    for (int i = 0; i < MICROBENCH_POINTS; i++) {
+        d.points[i] = v_make(vf->origin_x + frandf(0.0f, vf->gw * vf->cell_size),
+                             frandf(-10.0f, vf->extrude_h + 30.0f),
+                             vf->origin_z + frandf(0.0f, vf->gh * vf->cell_size));
+        d.box_points[i] = v_add(d.points[i], v_make(frandf(-8.0f, 8.0f), frandf(-20.0f, 20.0f), frandf(-8.0f, 8.0f)));
+    }
+    generate_level_starfield(&d.ctx.stars, vf, (int)strlen(MICROBENCH_PHRASE));
+    pool_init(&d.alloc_pool, STAR_COUNT);
+
+    /* run */
+    if (csv) {
+        printf("name,ops,runs,ns_per_op_min,ns_per_op_median,ns_per_op_mean\n");
+    } else {
+        printf("{\n  \"seed\": %u,\n  \"runs\": %d,\n  \"particle_kernel\": \"%s\",\n  \"results\": [\n",
+               seed, MICROBENCH_RUNS, particle_pool_kernel_name());
+    }
+    for (int b = 0; b < MICROBENCH_COUNT; b++) {
+        const MicroBench* mb = &microbenches[b];
+        double ns[MICROBENCH_RUNS];
+
+        /* first run is a warm up, every run starts from the same seed */
+        for (int r = -1; r < MICROBENCH_RUNS; r++) {
+            srand(seed);
+            if (mb->prepare) mb->prepare(&d);
+            double start = al_get_time();
+            mb->run(&d);
+            double elapsed = al_get_time() - start;
+            if (r >= 0) ns[r] = elapsed * 1e9 / (double)mb->ops;
+        }
+
+        double mean = 0.0;
+        for (int r = 0; r < MICROBENCH_RUNS; r++) mean += ns[r];
+        mean /= MICROBENCH_RUNS;
+        qsort(ns, MICROBENCH_RUNS, sizeof(double), compare_double);
+
+        if (csv) {
+            printf("%s,%d,%d,%.3f,%.3f,%.3f\n", mb->name, mb->ops, MICROBENCH_RUNS, ns[0], ns[MICROBENCH_RUNS / 2], mean);
+        } else {
+            printf("    {\"name\": \"%s\", \"ops\": %d, \"ns_per_op_min\": %.3f, \"ns_per_op_median\": %.3f, \"ns_per_op_mean\": %.3f}%s\n",
+                   mb->name, mb->ops, ns[0], ns[MICROBENCH_RUNS / 2], mean, b + 1 < MICROBENCH_COUNT ? "," : "");
+        }
+        fflush(stdout);
+    }
+    if (!csv) {
+        printf("  ]\n}\n");
+    }
+
+    pool_free(&d.alloc_pool);
+    free(d.points);
+    free(d.box_points);
+    free(d.config_text);
+    game_context_free(&d.ctx);
+    al_destroy_font(d.level_font);
+
+    app_config_free(&config);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**\file ttfe_particle_batch.c
+ *  screen space particle batches: one polygon per particle from a shared template, drawn in one call
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "ttfe_particle_batch.h"
+
+/* init a batch for capacity particles of 8 sides, it grows when needed */
+void particle_batch_init(ParticleBatch2D* batch, int capacity) {
+    memset(batch, 0, sizeof(ParticleBatch2D));
+    va_init(&batch->va, capacity * 8);
+}
+
+/* free a batch */
+void particle_batch_free(ParticleBatch2D* batch) {
+    va_free(&batch->va);
+    batch->sides = 0;
+}
+
+/* use a regular polygon of sides corners (3 to PARTICLE_BATCH_MAX_SIDES) rotated by angle, nothing is done if it is the current one */
+void particle_batch_set_template(ParticleBatch2D* batch, int sides, float angle) {
+    if (sides < 3) sides = 3;
+    if (sides > PARTICLE_BATCH_MAX_SIDES) sides = PARTICLE_BATCH_MAX_SIDES;
+    if (sides == batch->sides && angle == batch->angle) return;
+
+    for (int k = 0; k < sides; k++) {
+        float a = angle + 6.2831853f * (float)k / (float)sides;
+        batch->corner_x[k] = cosf(a);
+        batch->corner_y[k] = sinf(a);
+    }
+    batch->sides = sides;
+    batch->angle = angle;
+}
+
+/* one template polygon per particle of pool, at its x and y, scaled by its size */
+void particle_batch_build(ParticleBatch2D* batch, const ParticlePool* pool) {
+    VertexArray* va = &batch->va;
+    const int sides = batch->sides;
+    va_clear(va);
+    if (sides < 3 || pool->count == 0) return;
+
+    va_reserve(va, pool->count * sides);
+    va_reserve_indices(va, pool->count * (sides - 2) * 3);
+
+    ALLEGRO_VERTEX* v = va->v;
+    int* idx = va->indices;
+    for (int i = 0; i < pool->count; ++i) {
+        const float x = pool->x[i], y = pool->y[i], s = pool->size[i];
+        const ALLEGRO_COLOR c = pool->color[i];
+        const int base = i * sides;
+
+        for (int k = 0; k < sides; k++) {
+            v[k] = (ALLEGRO_VERTEX){x + batch->corner_x[k] * s, y + batch->corner_y[k] * s, 0.0f, 0.0f, 0.0f, c};
+        }
+        /* fan from the first corner */
+        for (int k = 1; k < sides - 1; k++) {
+            idx[0] = base;
+            idx[1] = base + k;
+            idx[2] = base + k + 1;
+            idx += 3;
+        }
+        v += sides;
+    }
+    va->count = pool->count * sides;
+    va->index_count = pool->count * (sides - 2) * 3;
+}
+
+/* draw the batch with a single call through the stream vbo */
+void particle_batch_draw(ParticleBatch2D* batch, TTFE_VBO* stream) {
+    vbo_draw(stream, &batch->va, ALLEGRO_PRIM_TRIANGLE_LIST);
+}
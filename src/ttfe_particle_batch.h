@@ -0,0 +1,50 @@
+/**\file ttfe_particle_batch.h
+ *  screen space particle batches: one polygon per particle from a shared template, drawn in one call
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#ifndef TTFE_PARTICLE_BATCH_HEADER_FOR_HACKS
+#define TTFE_PARTICLE_BATCH_HEADER_FOR_HACKS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ttfe_vector3d.h"
+#include "ttfe_vbo.h"
+#include "ttfe_particle_pool.h"
+
+/* most corners of a template polygon */
+#define PARTICLE_BATCH_MAX_SIDES 16
+
+/*
+ * The template is a regular polygon on the unit circle, computed once:
+ * a particle is its corners scaled by the particle size and moved to the
+ * particle x and y, triangulated as a fan from the first corner.
+ */
+typedef struct {
+    VertexArray va;
+    int sides;   /* 0 until particle_batch_set_template */
+    float angle; /* rotation of the first corner */
+    float corner_x[PARTICLE_BATCH_MAX_SIDES];
+    float corner_y[PARTICLE_BATCH_MAX_SIDES];
+} ParticleBatch2D;
+
+/* init a batch for capacity particles of 8 sides, it grows when needed */
+void particle_batch_init(ParticleBatch2D* batch, int capacity);
+/* free a batch */
+void particle_batch_free(ParticleBatch2D* batch);
+/* use a regular polygon of sides corners (3 to PARTICLE_BATCH_MAX_SIDES) rotated by angle, nothing is done if it is the current one */
+void particle_batch_set_template(ParticleBatch2D* batch, int sides, float angle);
+/* one template polygon per particle of pool, at its x and y, scaled by its size */
+void particle_batch_build(ParticleBatch2D* batch, const ParticlePool* pool);
+/* draw the batch with a single call through the stream vbo */
+void particle_batch_draw(ParticleBatch2D* batch, TTFE_VBO* stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,271 @@
+/**\file ttfe_particle_pool.c
+ *  structure of arrays particle pool with SIMD update kernels
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#include <string.h>
+#include <float.h>
+
+#include "ttfe_particle_pool.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PARTICLE_KERNEL_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define PARTICLE_KERNEL_SSE
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define PARTICLE_KERNEL_WASM
+#endif
+
+/* arrays are padded to this many floats */
+#define PARTICLE_PAD 8
+
+/* number of float arrays in the pool block */
+#define PARTICLE_FLOAT_ARRAYS 8
+
+/* init a particle pool */
+bool particle_pool_init(ParticlePool* pool, int capacity) {
+    memset(pool, 0, sizeof(ParticlePool));
+    int stride = (capacity + PARTICLE_PAD - 1) / PARTICLE_PAD * PARTICLE_PAD;
+
+    float* block = (float*)calloc((size_t)stride * PARTICLE_FLOAT_ARRAYS, sizeof(float));
+    pool->color = (ALLEGRO_COLOR*)calloc((size_t)stride, sizeof(ALLEGRO_COLOR));
+    if (!block || !pool->color) {
+        free(block);
+        free(pool->color);
+        pool->color = NULL;
+        return false;
+    }
+
+    pool->x = block;
+    pool->y = block + stride;
+    pool->z = block + stride * 2;
+    pool->vx = block + stride * 3;
+    pool->vy = block + stride * 4;
+    pool->vz = block + stride * 5;
+    pool->lifetime = block + stride * 6;
+    pool->size = block + stride * 7;
+    pool->capacity = capacity;
+    return true;
+}
+
+/* free a particle pool */
+void particle_pool_free(ParticlePool* pool) {
+    free(pool->x); /* start of the float block */
+    free(pool->color);
+    memset(pool, 0, sizeof(ParticlePool));
+}
+
+/* remove all particles */
+void particle_pool_clear(ParticlePool* pool) {
+    pool->count = 0;
+}
+
+/* add a particle, returns false if the pool is full */
+bool particle_pool_spawn(ParticlePool* pool, Vec3 pos, Vec3 vel, float lifetime, float size, ALLEGRO_COLOR color) {
+    if (pool->count >= pool->capacity) return false;
+
+    int i = pool->count++;
+    pool->x[i] = pos.x;
+    pool->y[i] = pos.y;
+    pool->z[i] = pos.z;
+    pool->vx[i] = vel.x;
+    pool->vy[i] = vel.y;
+    pool->vz[i] = vel.z;
+    pool->lifetime[i] = lifetime;
+    pool->size[i] = size;
+    pool->color[i] = color;
+    return true;
+}
+
+/* integrate [0, n), n being a multiple of PARTICLE_PAD. Returns true if a particle may have died */
+static bool particle_kernel(ParticlePool* pool, int n, float dt, float gravity_dt, float max_y) {
+    float* px = pool->x;
+    float* py = pool->y;
+    float* pz = pool->z;
+    float* vx = pool->vx;
+    float* vy = pool->vy;
+    float* vz = pool->vz;
+    float* life = pool->lifetime;
+    int i = 0;
+
+#if defined(PARTICLE_KERNEL_AVX)
+    __m256 vdt = _mm256_set1_ps(dt);
+    __m256 vg = _mm256_set1_ps(gravity_dt);
+    __m256 vmax = _mm256_set1_ps(max_y);
+    __m256 vzero = _mm256_setzero_ps();
+    __m256 dead = _mm256_setzero_ps();
+    for (; i < n; i += 8) {
+        __m256 y = _mm256_add_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(_mm256_loadu_ps(vy + i), vdt));
+        _mm256_storeu_ps(px + i, _mm256_add_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), vdt)));
+        _mm256_storeu_ps(py + i, y);
+        _mm256_storeu_ps(pz + i, _mm256_add_ps(_mm256_loadu_ps(pz + i), _mm256_mul_ps(_mm256_loadu_ps(vz + i), vdt)));
+        _mm256_storeu_ps(vy + i, _mm256_add_ps(_mm256_loadu_ps(vy + i), vg));
+        __m256 l = _mm256_sub_ps(_mm256_loadu_ps(life + i), vdt);
+        _mm256_storeu_ps(life + i, l);
+        dead = _mm256_or_ps(dead, _mm256_or_ps(_mm256_cmp_ps(l, vzero, _CMP_LE_OQ), _mm256_cmp_ps(y, vmax, _CMP_GT_OQ)));
+    }
+    return _mm256_movemask_ps(dead) != 0;
+#elif defined(PARTICLE_KERNEL_SSE)
+    __m128 vdt = _mm_set1_ps(dt);
+    __m128 vg = _mm_set1_ps(gravity_dt);
+    __m128 vmax = _mm_set1_ps(max_y);
+    __m128 vzero = _mm_setzero_ps();
+    __m128 dead = _mm_setzero_ps();
+    for (; i < n; i += 4) {
+        __m128 y = _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(_mm_loadu_ps(vy + i), vdt));
+        _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(_mm_loadu_ps(vx + i), vdt)));
+        _mm_storeu_ps(py + i, y);
+        _mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(_mm_loadu_ps(vz + i), vdt)));
+        _mm_storeu_ps(vy + i, _mm_add_ps(_mm_loadu_ps(vy + i), vg));
+        __m128 l = _mm_sub_ps(_mm_loadu_ps(life + i), vdt);
+        _mm_storeu_ps(life + i, l);
+        dead = _mm_or_ps(dead, _mm_or_ps(_mm_cmple_ps(l, vzero), _mm_cmpgt_ps(y, vmax)));
+    }
+    return _mm_movemask_ps(dead) != 0;
+#elif defined(PARTICLE_KERNEL_WASM)
+    v128_t vdt = wasm_f32x4_splat(dt);
+    v128_t vg = wasm_f32x4_splat(gravity_dt);
+    v128_t vmax = wasm_f32x4_splat(max_y);
+    v128_t vzero = wasm_f32x4_splat(0.0f);
+    v128_t dead = wasm_i32x4_splat(0);
+    for (; i < n; i += 4) {
+        v128_t y = wasm_f32x4_add(wasm_v128_load(py + i), wasm_f32x4_mul(wasm_v128_load(vy + i), vdt));
+        wasm_v128_store(px + i, wasm_f32x4_add(wasm_v128_load(px + i), wasm_f32x4_mul(wasm_v128_load(vx + i), vdt)));
+        wasm_v128_store(py + i, y);
+        wasm_v128_store(pz + i, wasm_f32x4_add(wasm_v128_load(pz + i), wasm_f32x4_mul(wasm_v128_load(vz + i), vdt)));
+        wasm_v128_store(vy + i, wasm_f32x4_add(wasm_v128_load(vy + i), vg));
+        v128_t l = wasm_f32x4_sub(wasm_v128_load(life + i), vdt);
+        wasm_v128_store(life + i, l);
+        dead = wasm_v128_or(dead, wasm_v128_or(wasm_f32x4_le(l, vzero), wasm_f32x4_gt(y, vmax)));
+    }
+    return wasm_v128_any_true(dead);
+#else
+    bool dead = false;
+    for (; i < n; i++) {
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+        pz[i] += vz[i] * dt;
+        vy[i] += gravity_dt;
+        life[i] -= dt;
+        dead |= (life[i] <= 0.0f) | (py[i] > max_y);
+    }
+    return dead;
+#endif
+}
+
+/* name of the compiled update kernel */
+const char* particle_pool_kernel_name(void) {
+#if defined(PARTICLE_KERNEL_AVX)
+    return "avx";
+#elif defined(PARTICLE_KERNEL_SSE)
+    return "sse";
+#elif defined(PARTICLE_KERNEL_WASM)
+    return "wasm-simd128";
+#else
+    return "scalar";
+#endif
+}
+
+/* integrate positions, apply gravity, decay lifetimes, and remove dead particles and those with y > max_y (FLT_MAX to disable) */
+void particle_pool_update(ParticlePool* pool, float dt, float gravity, float max_y) {
+    int n = (pool->count + PARTICLE_PAD - 1) / PARTICLE_PAD * PARTICLE_PAD;
+
+    /* neutral padding lanes, so they never look dead */
+    for (int i = pool->count; i < n; i++) {
+        pool->y[i] = -FLT_MAX;
+        pool->vy[i] = 0.0f;
+        pool->lifetime[i] = FLT_MAX;
+    }
+
+    /* same integration as entity_update_particle: position with the old velocity, then half gravity */
+    if (!particle_kernel(pool, n, dt, gravity * 0.5f * dt, max_y))
+        return;
+
+    /* swap-remove the dead ones */
+    int i = 0;
+    while (i < pool->count) {
+        if (pool->lifetime[i] > 0.0f && pool->y[i] <= max_y) {
+            i++;
+            continue;
+        }
+        int last = --pool->count;
+        pool->x[i] = pool->x[last];
+        pool->y[i] = pool->y[last];
+        pool->z[i] = pool->z[last];
+        pool->vx[i] = pool->vx[last];
+        pool->vy[i] = pool->vy[last];
+        pool->vz[i] = pool->vz[last];
+        pool->lifetime[i] = pool->lifetime[last];
+        pool->size[i] = pool->size[last];
+        pool->color[i] = pool->color[last];
+    }
+}
+
+/* 2D integration of [0, n), n being a multiple of PARTICLE_PAD. Returns true if a particle may be below max_y */
+static bool particle_kernel_2d(ParticlePool* pool, int n, float dt, float max_y) {
+    float* px = pool->x;
+    float* py = pool->y;
+    const float* vx = pool->vx;
+    const float* vy = pool->vy;
+    int i = 0;
+
+#if defined(PARTICLE_KERNEL_AVX)
+    __m256 vdt = _mm256_set1_ps(dt);
+    __m256 vmax = _mm256_set1_ps(max_y);
+    __m256 out = _mm256_setzero_ps();
+    for (; i < n; i += 8) {
+        __m256 y = _mm256_add_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(_mm256_loadu_ps(vy + i), vdt));
+        _mm256_storeu_ps(px + i, _mm256_add_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), vdt)));
+        _mm256_storeu_ps(py + i, y);
+        out = _mm256_or_ps(out, _mm256_cmp_ps(y, vmax, _CMP_GT_OQ));
+    }
+    return _mm256_movemask_ps(out) != 0;
+#elif defined(PARTICLE_KERNEL_SSE)
+    __m128 vdt = _mm_set1_ps(dt);
+    __m128 vmax = _mm_set1_ps(max_y);
+    __m128 out = _mm_setzero_ps();
+    for (; i < n; i += 4) {
+        __m128 y = _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(_mm_loadu_ps(vy + i), vdt));
+        _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(_mm_loadu_ps(vx + i), vdt)));
+        _mm_storeu_ps(py + i, y);
+        out = _mm_or_ps(out, _mm_cmpgt_ps(y, vmax));
+    }
+    return _mm_movemask_ps(out) != 0;
+#elif defined(PARTICLE_KERNEL_WASM)
+    v128_t vdt = wasm_f32x4_splat(dt);
+    v128_t vmax = wasm_f32x4_splat(max_y);
+    v128_t out = wasm_i32x4_splat(0);
+    for (; i < n; i += 4) {
+        v128_t y = wasm_f32x4_add(wasm_v128_load(py + i), wasm_f32x4_mul(wasm_v128_load(vy + i), vdt));
+        wasm_v128_store(px + i, wasm_f32x4_add(wasm_v128_load(px + i), wasm_f32x4_mul(wasm_v128_load(vx + i), vdt)));
+        wasm_v128_store(py + i, y);
+        out = wasm_v128_or(out, wasm_f32x4_gt(y, vmax));
+    }
+    return wasm_v128_any_true(out);
+#else
+    bool out = false;
+    for (; i < n; i++) {
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+        out |= (py[i] > max_y);
+    }
+    return out;
+#endif
+}
+
+/* screen space move: x and y only, no gravity nor lifetime. Returns true if a particle has y > max_y, the caller recycles those */
+bool particle_pool_update_2d(ParticlePool* pool, float dt, float max_y) {
+    int n = (pool->count + PARTICLE_PAD - 1) / PARTICLE_PAD * PARTICLE_PAD;
+
+    /* neutral padding lanes */
+    for (int i = pool->count; i < n; i++) {
+        pool->y[i] = -FLT_MAX;
+        pool->vy[i] = 0.0f;
+    }
+    return particle_kernel_2d(pool, n, dt, max_y);
+}
@@ -0,0 +1,56 @@
+/**\file ttfe_particle_pool.h
+ *  structure of arrays particle pool with SIMD update kernels
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#ifndef TTFE_PARTICLE_POOL_HEADER_FOR_HACKS
+#define TTFE_PARTICLE_POOL_HEADER_FOR_HACKS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ttfe_vector3d.h"
+
+/*
+ * Particles are kept packed in [0, count): a dead particle is replaced by
+ * the last one, so there is no active flag and the update kernels run on
+ * contiguous floats. Arrays are padded to a multiple of 8 so the kernels
+ * don't need a scalar tail.
+ */
+typedef struct {
+    float* x;
+    float* y;
+    float* z;
+    float* vx;
+    float* vy;
+    float* vz;
+    float* lifetime;
+    float* size;
+    ALLEGRO_COLOR* color;
+    int count;    /* live particles */
+    int capacity; /* maximum particles */
+} ParticlePool;
+
+/* init a particle pool */
+bool particle_pool_init(ParticlePool* pool, int capacity);
+/* free a particle pool */
+void particle_pool_free(ParticlePool* pool);
+/* remove all particles */
+void particle_pool_clear(ParticlePool* pool);
+/* add a particle, returns false if the pool is full */
+bool particle_pool_spawn(ParticlePool* pool, Vec3 pos, Vec3 vel, float lifetime, float size, ALLEGRO_COLOR color);
+/* integrate positions, apply gravity, decay lifetimes, and remove dead particles and those with y > max_y (FLT_MAX to disable) */
+void particle_pool_update(ParticlePool* pool, float dt, float gravity, float max_y);
+/* screen space move: x and y only, no gravity nor lifetime. Returns true if a particle has y > max_y, the caller recycles those */
+bool particle_pool_update_2d(ParticlePool* pool, float dt, float max_y);
+/* name of the compiled update kernel */
+const char* particle_pool_kernel_name(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,6 +5,8 @@
  *\date 18/12/2025
  */
 
+#include <float.h>
+
 #include "ttfe_particles.h"
 #include "ttfe_color.h"
 
@@ -13,9 +15,6 @@
 /* spawn particles when a box is hit helper */
 void spawn_box_hit_particles(GameContext* ctx, Vec3 pos, int count, float size_scale) {
     for (int i = 0; i < count; ++i) {
-        GameEntity* p = pool_alloc(&ctx->particles);
-        if (!p) break;
-
         Vec3 vel = v_make(
             frandf(-10.0f, 10.0f),
             frandf(5.0f, 15.0f),
@@ -32,10 +31,11 @@ void spawn_box_hit_particles(GameContext* ctx, Vec3 pos, int count, float size_s
         else
             color = al_map_rgb(255, 215, 0);
 
-        entity_init_particle(p, pos, vel,
-                             frandf(0.5f, 1.5f),
-                             size_scale * frandf(0.01f, 0.2f), /* use size_scale */
-                             color);
+        if (!particle_pool_spawn(&ctx->particles, pos, vel,
+                                 frandf(0.5f, 1.5f),
+                                 size_scale * frandf(0.01f, 0.2f), /* use size_scale */
+                                 color))
+            break;
     }
 }
 
@@ -56,9 +56,6 @@ void spawn_celebration_particles(GameContext* ctx) {
 /* spawn particles when hitting a wall */
 void spawn_wall_hit_particles(GameContext* ctx, Vec3 pos, int count) {
     for (int i = 0; i < count; ++i) {
-        GameEntity* p = pool_alloc(&ctx->particles);
-        if (!p) break;
-
         Vec3 vel = v_make(
             frandf(-8.0f, 8.0f),
             frandf(-2.0f, 10.0f),
@@ -66,10 +63,11 @@ void spawn_wall_hit_particles(GameContext* ctx, Vec3 pos, int count) {
 
         ALLEGRO_COLOR color = al_map_rgb(200 + rand() % 55, 20 + rand() % 80, 100 + rand() % 80);
 
-        entity_init_particle(p, pos, vel,
-                             frandf(0.3f, 1.0f),
-                             ctx->vf.cell_size * frandf(0.01f, 0.2f),
-                             color);
+        if (!particle_pool_spawn(&ctx->particles, pos, vel,
+                                 frandf(0.3f, 1.0f),
+                                 ctx->vf.cell_size * frandf(0.01f, 0.2f),
+                                 color))
+            break;
     }
 }
 
@@ -90,90 +88,99 @@ void fire_projectile(GameContext* ctx, ALLEGRO_SAMPLE* sfx_shoot, bool audio_ok,
 
 /* update all the projectiles actives in the list */
 void update_projectiles(GameContext* ctx, float dt, ALLEGRO_SAMPLE* sfx_hit_level, ALLEGRO_SAMPLE* sfx_hit_bonus, bool audio_ok, int* level_boxes_hit, int* level_time_bonus_boxes, int* level_speed_bonus_boxes, float speed_bonus_increment, float speed_max_limit) {
-    for (int i = 0; i < ctx->projectiles.capacity; ++i) {
-        GameEntity* proj = &ctx->projectiles.entities[i];
-        if (!entity_update_projectile(proj, dt)) continue;
+    /* boxes moved since the last tick */
+    box_grid_rebuild(&ctx->box_grid, &ctx->boxes);
+
+    /* backwards: releasing swaps the last active projectile in */
+    for (int k = ctx->projectiles.count - 1; k >= 0; --k) {
+        GameEntity* proj = &ctx->projectiles.entities[ctx->projectiles.active[k]];
+        if (!entity_update_projectile(proj, dt)) {
+            pool_release(&ctx->projectiles, proj);
+            continue;
+        }
 
         bool hit_something = false;
         bool hit_bonus = false;
 
         Vec3 from = proj->prev_pos;
         Vec3 to = proj->pos;
-        int steps = 4; /* or more if needed */
-
-        /* go along trajectory */
-        for (int i = 0; i <= steps; ++i) {
-            float t = (float)i / (float)steps;
-            Vec3 trajectory_point = v_add(from, v_scale(v_sub(to, from), t));
-
-            /* Check box collisions */
-            for (int b = 0; b < ctx->boxes.capacity && !hit_something; ++b) {
-                GameEntity* box = &ctx->boxes.entities[b];
-                if (!entity_is_active(box)) continue;
-
-                if (entity_box_contains_point(box, trajectory_point)) {
-                    /* if it's an obstacle, manage hp */
-                    if (box->flags & ENTITY_FLAG_OBSTACLE) {
-                        box->hp--;
-                        hit_something = true;
-                        hit_bonus = false;                                  /* for impact sound */
-                        spawn_wall_hit_particles(ctx, trajectory_point, 5); /* particles */
-                        entity_deactivate(proj);
-
-                        /* flash when hit */
-                        float ratio = (float)box->hp / (float)box->max_hp;
-                        box->color = al_map_rgb_f(0.8f * ratio, 0.2f * ratio, 0.2f * ratio);
-
-                        if (box->hp <= 0) {
-                            entity_deactivate(box);
-                            spawn_box_hit_particles(ctx, box->pos, 60, box->size); /* explosion */
-                            if (audio_ok && sfx_hit_level) {
-                                al_play_sample(sfx_hit_level, 0.8f, 0.0f, 1.5f, ALLEGRO_PLAYMODE_ONCE, NULL);
-                            }
-                            ctx->score += 50 * box->max_hp; /* size based score */
-                        }
-                    }
-                    /* classic bonus */
-                    else {
-                        entity_deactivate(box);
-                        entity_deactivate(proj);
-                        hit_something = true;
-                        hit_bonus = true;
-
-                        spawn_box_hit_particles(ctx, box->pos, 40, ctx->vf.cell_size);
-
-                        if (box->flags & ENTITY_FLAG_TIME_BONUS) {
-                            ctx->time_remaining += 30.0f;
-                            (*level_time_bonus_boxes)++;
-                            ctx->score += 15;
-                        } else if (box->flags & ENTITY_FLAG_SPEED_BONUS) {
-                            ctx->move_speed += speed_bonus_increment;
-                            if (ctx->move_speed > speed_max_limit)
-                                ctx->move_speed = speed_max_limit;
-                            if (ctx->move_speed > ctx->max_speed)
-                                ctx->max_speed = ctx->move_speed;
-                            (*level_speed_bonus_boxes)++;
-                            ctx->score += 15;
-                        } else {
-                            (*level_boxes_hit)++;
-                            ctx->score += 100;
-                        }
+
+        /* nearest box entered along the move, buckets of the move bounds only */
+        GameEntity* hit_box = NULL;
+        float t_hit = 1.0f;
+        int bx0, bz0, bx1, bz1;
+        box_grid_range(&ctx->box_grid, fminf(from.x, to.x), fminf(from.z, to.z), fmaxf(from.x, to.x), fmaxf(from.z, to.z), &bx0, &bz0, &bx1, &bz1);
+        for (int bz = bz0; bz <= bz1; ++bz) {
+            for (int bx = bx0; bx <= bx1; ++bx) {
+                const int* nearby = NULL;
+                int nearby_count = box_grid_bucket(&ctx->box_grid, bx, bz, &nearby);
+                for (int b = 0; b < nearby_count; ++b) {
+                    GameEntity* box = &ctx->boxes.entities[nearby[b]];
+                    float t;
+                    if (entity_is_active(box) && segment_aabb_hit(from, to, box->pos, box->size, &t) && (!hit_box || t < t_hit)) {
+                        hit_box = box;
+                        t_hit = t;
                     }
-                    break;
                 }
             }
+        }
 
-            /* Check environment collision */
-            if (!hit_something) {
-                if (trajectory_point.y >= 0.0f && trajectory_point.y <= ctx->vf.extrude_h) {
-                    int gx, gy;
-                    world_to_grid(&ctx->vf, trajectory_point.x, trajectory_point.z, &gx, &gy);
-                    if (is_solid(&ctx->vf, gx, gy)) {
-                        entity_deactivate(proj);
-                        hit_something = true;
-                        hit_bonus = false;
-                        spawn_wall_hit_particles(ctx, trajectory_point, 25);
+        /* level cells crossed before that box */
+        float t_level;
+        if (voxel_ray_cast(&ctx->vf, from, to, &t_level) && (!hit_box || t_level < t_hit)) {
+            Vec3 hit_point = v_add(from, v_scale(v_sub(to, from), t_level));
+            pool_release(&ctx->projectiles, proj);
+            hit_something = true;
+            hit_bonus = false;
+            spawn_wall_hit_particles(ctx, hit_point, 25);
+        } else if (hit_box) {
+            GameEntity* box = hit_box;
+            Vec3 hit_point = v_add(from, v_scale(v_sub(to, from), t_hit));
+            /* if it's an obstacle, manage hp */
+            if (box->flags & ENTITY_FLAG_OBSTACLE) {
+                box->hp--;
+                hit_something = true;
+                hit_bonus = false;                         /* for impact sound */
+                spawn_wall_hit_particles(ctx, hit_point, 5); /* particles */
+                pool_release(&ctx->projectiles, proj);
+
+                /* flash when hit */
+                float ratio = (float)box->hp / (float)box->max_hp;
+                box->color = al_map_rgb_f(0.8f * ratio, 0.2f * ratio, 0.2f * ratio);
+
+                if (box->hp <= 0) {
+                    pool_release(&ctx->boxes, box);
+                    spawn_box_hit_particles(ctx, box->pos, 60, box->size); /* explosion */
+                    if (audio_ok && sfx_hit_level) {
+                        al_play_sample(sfx_hit_level, 0.8f, 0.0f, 1.5f, ALLEGRO_PLAYMODE_ONCE, NULL);
                     }
+                    ctx->score += 50 * box->max_hp; /* size based score */
+                }
+            }
+            /* classic bonus */
+            else {
+                pool_release(&ctx->boxes, box);
+                pool_release(&ctx->projectiles, proj);
+                hit_something = true;
+                hit_bonus = true;
+
+                spawn_box_hit_particles(ctx, box->pos, 40, ctx->vf.cell_size);
+
+                if (box->flags & ENTITY_FLAG_TIME_BONUS) {
+                    ctx->time_remaining += 30.0f;
+                    (*level_time_bonus_boxes)++;
+                    ctx->score += 15;
+                } else if (box->flags & ENTITY_FLAG_SPEED_BONUS) {
+                    ctx->move_speed += speed_bonus_increment;
+                    if (ctx->move_speed > speed_max_limit)
+                        ctx->move_speed = speed_max_limit;
+                    if (ctx->move_speed > ctx->max_speed)
+                        ctx->max_speed = ctx->move_speed;
+                    (*level_speed_bonus_boxes)++;
+                    ctx->score += 15;
+                } else {
+                    (*level_boxes_hit)++;
+                    ctx->score += 100;
                 }
             }
         }
@@ -192,9 +199,7 @@ void update_projectiles(GameContext* ctx, float dt, ALLEGRO_SAMPLE* sfx_hit_leve
 
 /* update particles position */
 void update_particles(GameContext* ctx, float gravity, float dt) {
-    for (int i = 0; i < ctx->particles.capacity; ++i) {
-        entity_update_particle(&ctx->particles.entities[i], dt, gravity);
-    }
+    particle_pool_update(&ctx->particles, dt, gravity, FLT_MAX);
 }
 
 /* update pink lights position */
@@ -202,58 +207,107 @@ void update_pink_lights(GameContext* ctx, float dt) {
     const float begin_x = ctx->vf.origin_x;                                /* beginning of level */
     const float end_x = ctx->vf.origin_x + ctx->vf.gw * ctx->vf.cell_size; /* end of level */
 
-    for (int i = 0; i < ctx->pink_lights.capacity; ++i) {
-        GameEntity* l = &ctx->pink_lights.entities[i];
-        if (!entity_is_active(l)) continue;
+    for (int k = 0; k < ctx->pink_lights.count; ++k) {
+        GameEntity* l = &ctx->pink_lights.entities[ctx->pink_lights.active[k]];
 
         const float speed = l->vel.x;
 
         /* Move from end -> beginning (toward smaller x). Flip sign if your level direction is opposite. */
+        l->prev_pos = l->pos;
         l->pos.x -= speed * dt;
 
         /* If it went past the beginning, respawn back at the end */
         if (l->pos.x < begin_x - ctx->vf.cell_size) {
             l->pos.x = end_x + frandf(0.0f, 5.0f * ctx->vf.cell_size);
+            l->prev_pos = l->pos; /* no interpolation across the jump */
         }
     }
 }
 
+/* fill the intro snow pool over the screen */
+void spawn_intro_snow(GameContext* ctx) {
+    const ALLEGRO_COLOR white = al_map_rgb(255, 255, 255);
+    particle_pool_clear(&ctx->intro_snow);
+    while (particle_pool_spawn(&ctx->intro_snow,
+                               v_make(frandf(0.0f, (float)ctx->dw), frandf(-(float)ctx->dh, 0.0f), 0.0f),
+                               v_make(0.0f, frandf(30.0f, 80.0f), 0.0f),
+                               FLT_MAX, frandf(2.0f, 6.0f), white))
+        ;
+}
+
+/* update intro snow position, flakes leaving the bottom of the screen come back from the top */
+void update_intro_snow(GameContext* ctx, float dt) {
+    ParticlePool* snow = &ctx->intro_snow;
+    const float h = (float)ctx->dh;
+    if (!particle_pool_update_2d(snow, dt, h)) return;
+
+    for (int i = 0; i < snow->count; ++i) {
+        if (snow->y[i] - snow->size[i] <= h) continue;
+        snow->x[i] = frandf(0.0f, (float)ctx->dw);
+        snow->y[i] = frandf(-h * 0.5f, 0.0f);
+        snow->vy[i] = frandf(30.0f, 80.0f);
+        snow->size[i] = frandf(2.0f, 6.0f);
+    }
+}
+
 /* RENDERING FUNCTIONS */
 
-/* render bonus boxes */
-void render_boxes(GameContext* ctx) {
+/* render bonus boxes in the frustum (all if NULL), alpha is the interpolation factor between the last two ticks */
+void render_boxes(GameContext* ctx, const Frustum* frustum, float alpha) {
     va_clear(&ctx->va_boxes);
 
-    for (int i = 0; i < ctx->boxes.capacity; ++i) {
-        GameEntity* box = &ctx->boxes.entities[i];
-        if (!entity_is_active(box)) continue;
+    for (int k = 0; k < ctx->boxes.count; ++k) {
+        GameEntity* box = &ctx->boxes.entities[ctx->boxes.active[k]];
+        /* bounding sphere of the cube */
+        if (frustum && !frustum_sphere_visible(frustum, entity_render_pos(box, alpha), box->size * 1.7320508f)) continue;
 
         ALLEGRO_COLOR shade_top = shade_color(box->color, 0.0f, 1.0f, 0.0f);
-        entity_add_box(box, &ctx->va_boxes, shade_top);
+        entity_add_box(box, &ctx->va_boxes, shade_top, alpha);
     }
     vbo_draw(&ctx->g_ttfe_stream_vbo, &ctx->va_boxes, ALLEGRO_PRIM_TRIANGLE_LIST);
 }
 
-/* render particles */
-void render_particles(GameContext* ctx, Vec3 cam_right, Vec3 cam_up) {
+/* render particles in the frustum (all if NULL), alpha is the interpolation factor between the last two ticks of length dt. dt 0 for particles that did not move */
+void render_particles(GameContext* ctx, const Frustum* frustum, Vec3 cam_right, Vec3 cam_up, float alpha, float dt) {
     va_clear(&ctx->va_particles);
 
-    for (int i = 0; i < ctx->particles.capacity; ++i) {
-        GameEntity* p = &ctx->particles.entities[i];
-        if (!entity_is_active(p)) continue;
-
-        if (p->size <= 0.0f)
-            p->size = ctx->vf.cell_size * frandf(0.01f, 0.2f);
-
-        entity_add_billboard(p, &ctx->va_particles, cam_right, cam_up);
+    const ParticlePool* pp = &ctx->particles;
+    /* no previous position in the pool: step back along the velocity */
+    const float lag = (alpha - 1.0f) * dt;
+    va_reserve(&ctx->va_particles, pp->count * 4);
+    va_reserve_indices(&ctx->va_particles, pp->count * 6);
+
+    for (int i = 0; i < pp->count; ++i) {
+        Vec3 pos = v_make(pp->x[i] + pp->vx[i] * lag, pp->y[i] + pp->vy[i] * lag, pp->z[i] + pp->vz[i] * lag);
+        if (frustum && !frustum_sphere_visible(frustum, pos, pp->size[i])) continue;
+
+        Vec3 right = v_scale(cam_right, pp->size[i]);
+        Vec3 up = v_scale(cam_up, pp->size[i]);
+
+        Vec3 p0 = v_sub(pos, v_add(right, up));
+        Vec3 p1 = v_add(pos, v_sub(right, up));
+        Vec3 p2 = v_add(pos, v_add(right, up));
+        Vec3 p3 = v_sub(pos, v_sub(right, up));
+
+        ALLEGRO_VERTEX* v = ctx->va_particles.v + ctx->va_particles.count;
+        v[0] = (ALLEGRO_VERTEX){p0.x, p0.y, p0.z, 0, 0, pp->color[i]};
+        v[1] = (ALLEGRO_VERTEX){p1.x, p1.y, p1.z, 0, 0, pp->color[i]};
+        v[2] = (ALLEGRO_VERTEX){p2.x, p2.y, p2.z, 0, 0, pp->color[i]};
+        v[3] = (ALLEGRO_VERTEX){p3.x, p3.y, p3.z, 0, 0, pp->color[i]};
+        va_add_quad_indices(&ctx->va_particles, ctx->va_particles.count);
+        ctx->va_particles.count += 4;
     }
     vbo_draw(&ctx->g_ttfe_stream_vbo, &ctx->va_particles, ALLEGRO_PRIM_TRIANGLE_LIST);
 }
 
-/* render projectiles */
-void render_projectiles(GameContext* ctx) {
-    Vec3 forward = camera_forward(&ctx->cam);
-    Vec3 right = v_make(cosf(ctx->cam.yaw), 0.0f, -sinf(ctx->cam.yaw));
+/* render projectiles in one draw, then their trails in one draw without depth writes. view is the interpolated camera, alpha the interpolation factor between the last two ticks */
+void render_projectiles(GameContext* ctx, const Camera* view, float alpha) {
+    VertexArray* va = &ctx->va_projectiles;
+    va_clear(va);
+    if (ctx->projectiles.count == 0) return;
+
+    Vec3 forward = camera_forward(view);
+    Vec3 right = v_make(cosf(view->yaw), 0.0f, -sinf(view->yaw));
     right = v_normalize(right);
     Vec3 up = v_cross(right, forward);
     up = v_normalize(up);
@@ -262,32 +316,79 @@ void render_projectiles(GameContext* ctx) {
     Vec3 right_scaled = v_scale(right, HALF_SIZE);
     Vec3 up_scaled = v_scale(up, HALF_SIZE);
 
-    for (int i = 0; i < ctx->projectiles.capacity; ++i) {
-        GameEntity* proj = &ctx->projectiles.entities[i];
-        if (!entity_is_active(proj)) continue;
+    const ALLEGRO_COLOR top = al_map_rgb(255, 200, 200);
+    const ALLEGRO_COLOR bottom = al_map_rgb(255, 150, 150);
+    /* premultiplied alpha, fading to nothing at the tail */
+    const ALLEGRO_COLOR trail_head = al_map_rgba_f(0.5f, 0.3f, 0.3f, 0.5f);
+    const ALLEGRO_COLOR trail_tail = al_map_rgba_f(0.0f, 0.0f, 0.0f, 0.0f);
 
-        Vec3 p = proj->pos;
-        Vec3 p0 = v_add(v_sub(p, right_scaled), up_scaled);
-        Vec3 p1 = v_add(v_add(p, right_scaled), up_scaled);
-        Vec3 p2 = v_sub(v_sub(p, right_scaled), up_scaled);
-        Vec3 p3 = v_sub(v_add(p, right_scaled), up_scaled);
+    va_reserve(va, ctx->projectiles.count * 4);
+    va_reserve_indices(va, ctx->projectiles.count * 6);
 
-        ALLEGRO_VERTEX verts[4];
-        verts[0] = (ALLEGRO_VERTEX){p0.x, p0.y, p0.z, 0.0f, 0.0f, al_map_rgb(255, 200, 200)};
-        verts[1] = (ALLEGRO_VERTEX){p1.x, p1.y, p1.z, 1.0f, 0.0f, al_map_rgb(255, 200, 200)};
-        verts[2] = (ALLEGRO_VERTEX){p2.x, p2.y, p2.z, 0.0f, 1.0f, al_map_rgb(255, 150, 150)};
-        verts[3] = (ALLEGRO_VERTEX){p3.x, p3.y, p3.z, 1.0f, 1.0f, al_map_rgb(255, 150, 150)};
+    for (int k = 0; k < ctx->projectiles.count; ++k) {
+        GameEntity* proj = &ctx->projectiles.entities[ctx->projectiles.active[k]];
+        Vec3 p = entity_render_pos(proj, alpha);
 
-        al_draw_prim(verts, NULL, NULL, 0, 4, ALLEGRO_PRIM_TRIANGLE_STRIP);
+        Vec3 p0 = v_add(v_sub(p, right_scaled), up_scaled);
+        Vec3 p1 = v_add(v_add(p, right_scaled), up_scaled);
+        Vec3 p2 = v_sub(v_add(p, right_scaled), up_scaled);
+        Vec3 p3 = v_sub(v_sub(p, right_scaled), up_scaled);
+
+        ALLEGRO_VERTEX* v = va->v + va->count;
+        v[0] = (ALLEGRO_VERTEX){p0.x, p0.y, p0.z, 0.0f, 0.0f, top};
+        v[1] = (ALLEGRO_VERTEX){p1.x, p1.y, p1.z, 1.0f, 0.0f, top};
+        v[2] = (ALLEGRO_VERTEX){p2.x, p2.y, p2.z, 1.0f, 1.0f, bottom};
+        v[3] = (ALLEGRO_VERTEX){p3.x, p3.y, p3.z, 0.0f, 1.0f, bottom};
+        va_add_quad_indices(va, va->count);
+        va->count += 4;
+    }
+    vbo_draw(&ctx->g_ttfe_stream_vbo, va, ALLEGRO_PRIM_TRIANGLE_LIST);
+
+    if (!ctx->projectile_trails) return;
+
+    /* trails: the last tick move behind each projectile, widened across the view ray */
+    va_clear(va);
+    for (int k = 0; k < ctx->projectiles.count; ++k) {
+        GameEntity* proj = &ctx->projectiles.entities[ctx->projectiles.active[k]];
+        Vec3 p = entity_render_pos(proj, alpha);
+        Vec3 move = v_sub(proj->pos, proj->prev_pos);
+        Vec3 side = v_cross(move, v_sub(p, view->position));
+        float side_len = v_norm(side);
+        if (side_len <= 1e-4f) continue;
+
+        side = v_scale(side, HALF_SIZE * 0.6f / side_len);
+        Vec3 tail = v_sub(p, move);
+        Vec3 t0 = v_sub(p, side), t1 = v_add(p, side);
+        Vec3 t2 = v_add(tail, side), t3 = v_sub(tail, side);
+
+        ALLEGRO_VERTEX* v = va->v + va->count;
+        v[0] = (ALLEGRO_VERTEX){t0.x, t0.y, t0.z, 0.0f, 0.0f, trail_head};
+        v[1] = (ALLEGRO_VERTEX){t1.x, t1.y, t1.z, 0.0f, 0.0f, trail_head};
+        v[2] = (ALLEGRO_VERTEX){t2.x, t2.y, t2.z, 0.0f, 0.0f, trail_tail};
+        v[3] = (ALLEGRO_VERTEX){t3.x, t3.y, t3.z, 0.0f, 0.0f, trail_tail};
+        va_add_quad_indices(va, va->count);
+        va->count += 4;
     }
+    if (va->count == 0) return;
+
+    /* transparent: depth tested against the projectiles, but not written */
+    al_set_render_state(ALLEGRO_ALPHA_TEST, 0);
+    al_set_render_state(ALLEGRO_WRITE_MASK, ALLEGRO_MASK_RGBA);
+    vbo_draw(&ctx->g_ttfe_stream_vbo, va, ALLEGRO_PRIM_TRIANGLE_LIST);
+    al_set_render_state(ALLEGRO_WRITE_MASK, ALLEGRO_MASK_DEPTH | ALLEGRO_MASK_RGBA);
 }
 
-/* render snow */
+/* render snow, in one draw */
 void render_intro_snow(GameContext* ctx) {
-    for (int i = 0; i < ctx->intro_snow.capacity; ++i) {
-        GameEntity* snow = &ctx->intro_snow.entities[i];
-        if (!entity_is_active(snow)) continue;
+    particle_batch_set_template(&ctx->batch_2d, 8, 0.0f);
+    particle_batch_build(&ctx->batch_2d, &ctx->intro_snow);
+    particle_batch_draw(&ctx->batch_2d, &ctx->g_ttfe_stream_vbo);
+}
 
-        al_draw_filled_circle(snow->pos.x, snow->pos.y, snow->size, snow->color);
-    }
+/* render the outro confetti, in one draw */
+void render_confetti(GameContext* ctx) {
+    /* squares */
+    particle_batch_set_template(&ctx->batch_2d, 4, 0.7853982f);
+    particle_batch_build(&ctx->batch_2d, &ctx->particles);
+    particle_batch_draw(&ctx->batch_2d, &ctx->g_ttfe_stream_vbo);
 }
@@ -31,15 +31,21 @@ void update_projectiles(GameContext* ctx, float dt, ALLEGRO_SAMPLE* sfx_hit_leve
 void update_particles(GameContext* ctx, float gravity, float dt);
 /* update pink lights position */
 void update_pink_lights(GameContext* ctx, float dt);
+/* fill the intro snow pool over the screen */
+void spawn_intro_snow(GameContext* ctx);
+/* update intro snow position, flakes leaving the bottom of the screen come back from the top */
+void update_intro_snow(GameContext* ctx, float dt);
 
 /* render bonus boxes */
-void render_boxes(GameContext* ctx);
+void render_boxes(GameContext* ctx, const Frustum* frustum, float alpha);
 /* render particles */
-void render_particles(GameContext* ctx, Vec3 cam_right, Vec3 cam_up);
-/* render projectiles */
-void render_projectiles(GameContext* ctx);
-/* render snow */
+void render_particles(GameContext* ctx, const Frustum* frustum, Vec3 cam_right, Vec3 cam_up, float alpha, float dt);
+/* render projectiles in one draw, then their trails in one draw without depth writes */
+void render_projectiles(GameContext* ctx, const Camera* view, float alpha);
+/* render snow, in one draw */
 void render_intro_snow(GameContext* ctx);
+/* render the outro confetti, in one draw */
+void render_confetti(GameContext* ctx);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,142 @@
+/**\file ttfe_prefetch.c
+ *  background preparation of the next level while the current one is played
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ttfe_prefetch.h"
+#include "ttfe_level.h"
+#include "nilorea/n_log.h"
+
+/* worker: everything after voxelization that doesn't need the display */
+static void* prefetch_thread(ALLEGRO_THREAD* thread, void* arg) {
+    (void)thread;
+    LevelPrefetch* lp = (LevelPrefetch*)arg;
+
+    if (lp->cached) {
+        lp->ok = level_cache_load(lp->cache, lp->cache_key, &lp->vf, &lp->va_level, &lp->va_overlay_letters, &lp->va_overlay_goals);
+    } else {
+        lp->ok = build_level_meshes(&lp->vf, &lp->va_level, &lp->va_overlay_letters, &lp->va_overlay_goals, NULL);
+        if (lp->ok)
+            level_cache_store(lp->cache, lp->cache_key, &lp->vf, &lp->va_level, &lp->va_overlay_letters, &lp->va_overlay_goals);
+    }
+    if (lp->ok && lp->song_file) {
+        lp->song = al_load_sample(lp->song_file);
+        if (!lp->song)
+            n_log(LOG_ERR, "unable to load song %s", lp->song_file);
+    }
+    return NULL;
+}
+
+/* wait for the worker if one is running */
+static void prefetch_wait(LevelPrefetch* lp) {
+    if (lp->thread) {
+        al_join_thread(lp->thread, NULL);
+        al_destroy_thread(lp->thread);
+        lp->thread = NULL;
+    }
+}
+
+/* drop the current prefetch, if any */
+static void prefetch_discard(LevelPrefetch* lp) {
+    prefetch_wait(lp);
+    voxel_field_free(&lp->vf);
+    if (lp->song) {
+        al_destroy_sample(lp->song);
+        lp->song = NULL;
+    }
+    lp->level_index = -1;
+}
+
+/* init a prefetcher, sized like the GameContext level buffers */
+void level_prefetch_init(LevelPrefetch* lp) {
+    memset(lp, 0, sizeof(LevelPrefetch));
+    lp->level_index = -1;
+    va_init(&lp->va_level, 4096);
+    va_init(&lp->va_overlay_letters, 4096);
+    va_init(&lp->va_overlay_goals, 1024);
+}
+
+/* wait for the worker and free everything */
+void level_prefetch_free(LevelPrefetch* lp) {
+    prefetch_discard(lp);
+    va_free(&lp->va_level);
+    va_free(&lp->va_overlay_letters);
+    va_free(&lp->va_overlay_goals);
+}
+
+/* start preparing level_index. song_file may be NULL. Returns false if nothing was started (no threads, build failure) */
+bool level_prefetch_start(LevelPrefetch* lp, const LevelCache* cache, int level_index, ALLEGRO_FONT* level_font, const char* phrase, int level_font_size, const char* song_file) {
+    prefetch_discard(lp);
+
+#ifdef __EMSCRIPTEN__
+    /* no worker threads in the wasm build, levels are built on demand */
+    (void)cache;
+    (void)level_index;
+    (void)level_font;
+    (void)phrase;
+    (void)level_font_size;
+    (void)song_file;
+    return false;
+#else
+    lp->phrase_len = (int)strlen(phrase);
+    lp->song_file = song_file;
+    lp->ok = false;
+    lp->cache = cache;
+    lp->cache_key = level_cache_key(cache, phrase, level_font_size);
+    lp->cached = level_cache_contains(cache, lp->cache_key);
+
+    if (!lp->cached && !build_level_voxels(&lp->vf, level_font, NULL, phrase, lp->phrase_len, level_font_size)) {
+        voxel_field_free(&lp->vf);
+        return false;
+    }
+
+    lp->thread = al_create_thread(prefetch_thread, lp);
+    if (!lp->thread) {
+        n_log(LOG_ERR, "unable to create prefetch thread for level %d", level_index + 1);
+        voxel_field_free(&lp->vf);
+        return false;
+    }
+    lp->level_index = level_index;
+    al_start_thread(lp->thread);
+    return true;
+#endif
+}
+
+/* if level_index was prefetched, wait for it and move it into ctx. The song (may be NULL) is handed over in *song. Returns false if the level must be built the normal way */
+bool level_prefetch_take(LevelPrefetch* lp, GameContext* ctx, int level_index, ALLEGRO_SAMPLE** song) {
+    if (lp->level_index != level_index) {
+        prefetch_discard(lp);
+        return false;
+    }
+
+    prefetch_wait(lp);
+    if (!lp->ok) {
+        prefetch_discard(lp);
+        return false;
+    }
+
+    /* vf is moved, the buffers are swapped so both sides keep their allocations */
+    voxel_field_free(&ctx->vf);
+    ctx->vf = lp->vf;
+    memset(&lp->vf, 0, sizeof(VoxelField));
+
+    VertexArray va_tmp = ctx->va_level;
+    ctx->va_level = lp->va_level;
+    lp->va_level = va_tmp;
+    va_tmp = ctx->va_overlay_letters;
+    ctx->va_overlay_letters = lp->va_overlay_letters;
+    lp->va_overlay_letters = va_tmp;
+    va_tmp = ctx->va_overlay_goals;
+    ctx->va_overlay_goals = lp->va_overlay_goals;
+    lp->va_overlay_goals = va_tmp;
+
+    *song = lp->song;
+    lp->song = NULL;
+    lp->level_index = -1;
+    return true;
+}
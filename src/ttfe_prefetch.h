@@ -0,0 +1,59 @@
+/**\file ttfe_prefetch.h
+ *  background preparation of the next level while the current one is played
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#ifndef TTFE_PREFETCH_HEADER_FOR_HACKS
+#define TTFE_PREFETCH_HEADER_FOR_HACKS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+#include <allegro5/allegro_audio.h>
+
+#include "ttfe_game_context.h"
+
+/*
+ * The text rasterization and voxelization of the next level run on the
+ * display thread when the prefetch starts (font + bitmap access), then a
+ * worker builds the greedy meshes and decodes the song while the current
+ * level is played. The starfield is left to the display thread: it draws
+ * from rand(), which is not thread safe. A level found in the level cache is
+ * loaded by the worker, skipping the display thread part. Taking the
+ * result only leaves the static buffer upload for the level transition.
+ */
+typedef struct {
+    int level_index; /* prefetched level, -1 if none */
+    int phrase_len;
+    const char* song_file;
+    const LevelCache* cache;
+    uint64_t cache_key;
+    bool cached; /* level found in the cache, the worker loads it */
+    ALLEGRO_THREAD* thread;
+    bool ok; /* worker result */
+    VoxelField vf;
+    VertexArray va_level;
+    VertexArray va_overlay_letters;
+    VertexArray va_overlay_goals;
+    ALLEGRO_SAMPLE* song;
+} LevelPrefetch;
+
+/* init a prefetcher, sized like the GameContext level buffers */
+void level_prefetch_init(LevelPrefetch* lp);
+/* wait for the worker and free everything */
+void level_prefetch_free(LevelPrefetch* lp);
+/* start preparing level_index. song_file may be NULL. Returns false if nothing was started (no threads, build failure) */
+bool level_prefetch_start(LevelPrefetch* lp, const LevelCache* cache, int level_index, ALLEGRO_FONT* level_font, const char* phrase, int level_font_size, const char* song_file);
+/* if level_index was prefetched, wait for it and move it into ctx. The song (may be NULL) is handed over in *song. Returns false if the level must be built the normal way */
+bool level_prefetch_take(LevelPrefetch* lp, GameContext* ctx, int level_index, ALLEGRO_SAMPLE** song);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
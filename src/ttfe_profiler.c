@@ -0,0 +1,215 @@
+/**\file ttfe_profiler.c
+ *  in game profiler: CPU time of each phase of the main loop, draw counters and a frame time graph
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <allegro5/allegro_primitives.h>
+
+#include "ttfe_profiler.h"
+#include "ttfe_vbo.h"
+
+/* overlay layout, in pixels */
+#define PROFILER_PANEL_W 440
+#define PROFILER_GRAPH_H 80
+/* frame time at the top of the graph, in seconds */
+#define PROFILER_GRAPH_MAX (1.0f / 20.0f)
+
+static const char* profiler_phase_names[PROF_PHASE_COUNT] = {
+    "events",
+    "logic",
+    "starfield",
+    "level",
+    "overlay",
+    "pink lights",
+    "boxes",
+    "particles",
+    "projectiles",
+    "hud",
+    "flip"};
+
+static const char* profiler_counter_names[PROF_COUNTER_COUNT] = {
+    "draw calls",
+    "vertices",
+    "logic ticks",
+    "level chunks",
+    "ring orphans"};
+
+/* name of a ProfilerPhase */
+const char* profiler_phase_name(int phase) {
+    if (phase < 0 || phase >= PROF_PHASE_COUNT) return "?";
+    return profiler_phase_names[phase];
+}
+
+/* name of a ProfilerCounter */
+const char* profiler_counter_name(int counter) {
+    if (counter < 0 || counter >= PROF_COUNTER_COUNT) return "?";
+    return profiler_counter_names[counter];
+}
+
+/* init a disabled profiler */
+void profiler_init(Profiler* prof) {
+    memset(prof, 0, sizeof(Profiler));
+}
+
+/* enable or disable, the history is restarted when enabling */
+void profiler_toggle(Profiler* prof) {
+    prof->enabled = !prof->enabled;
+    if (!prof->enabled) return;
+
+    prof->head = 0;
+    prof->filled = 0;
+    memset(prof->current, 0, sizeof(prof->current));
+    memset(prof->current_counters, 0, sizeof(prof->current_counters));
+    prof->frame_start = prof->mark = al_get_time();
+}
+
+/* start a measured span, time since the last mark is not counted */
+void profiler_start(Profiler* prof) {
+    if (!prof->enabled) return;
+    prof->mark = al_get_time();
+}
+
+/* add the time since the last mark to phase, and restart the span */
+void profiler_mark(Profiler* prof, int phase) {
+    if (!prof->enabled) return;
+    double now = al_get_time();
+    prof->current[phase] += (float)(now - prof->mark);
+    prof->mark = now;
+}
+
+/* add n to a counter of the running frame */
+void profiler_count(Profiler* prof, int counter, int n) {
+    if (!prof->enabled) return;
+    prof->current_counters[counter] += n;
+}
+
+/* close the running frame: store it in the history with the VBO draw stats, which are cleared */
+void profiler_frame_end(Profiler* prof) {
+    if (prof->enabled) {
+        double now = al_get_time();
+        int h = prof->head;
+
+        prof->current_counters[PROF_COUNTER_DRAW_CALLS] += ttfe_vbo_stats.draw_calls;
+        prof->current_counters[PROF_COUNTER_VERTICES] += ttfe_vbo_stats.vertices_uploaded;
+        prof->current_counters[PROF_COUNTER_ORPHANS] += ttfe_vbo_stats.ring_orphans;
+
+        for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+            prof->phase_history[p][h] = prof->current[p];
+            prof->current[p] = 0.0f;
+        }
+        for (int c = 0; c < PROF_COUNTER_COUNT; c++) {
+            prof->counter_history[c][h] = prof->current_counters[c];
+            prof->current_counters[c] = 0;
+        }
+        prof->frame_history[h] = (float)(now - prof->frame_start);
+        prof->frame_start = now;
+
+        prof->head = (h + 1) % PROFILER_HISTORY;
+        if (prof->filled < PROFILER_HISTORY) prof->filled++;
+    }
+    ttfe_vbo_stats.draw_calls = 0;
+    ttfe_vbo_stats.vertices_uploaded = 0;
+    ttfe_vbo_stats.ring_orphans = 0;
+}
+
+static int profiler_cmp_float(const void* a, const void* b) {
+    float fa = *(const float*)a;
+    float fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+/* min, average and 99th percentile (nearest rank) of the n first values */
+static void profiler_stats(const float* values, int n, float* min, float* avg, float* p99) {
+    float sorted[PROFILER_HISTORY];
+    float sum = 0.0f;
+
+    memcpy(sorted, values, sizeof(float) * n);
+    qsort(sorted, n, sizeof(float), profiler_cmp_float);
+    for (int i = 0; i < n; i++) sum += sorted[i];
+
+    int rank = (int)ceilf(0.99f * (float)n) - 1;
+    if (rank < 0) rank = 0;
+    *min = sorted[0];
+    *avg = sum / (float)n;
+    *p99 = sorted[rank];
+}
+
+/* draw the stats table and the frame time graph, top right of a dw wide screen */
+void profiler_draw(const Profiler* prof, ALLEGRO_FONT* font, int dw) {
+    if (!prof->enabled || prof->filled == 0 || !font) return;
+
+    int n = prof->filled;
+    int lh = al_get_font_line_height(font);
+    int rows = 3 + PROF_PHASE_COUNT + PROF_COUNTER_COUNT;
+    float x = (float)(dw - PROFILER_PANEL_W - 10);
+    float y = 10.0f;
+    float col_min = x + 250.0f, col_avg = x + 330.0f, col_p99 = x + PROFILER_PANEL_W - 10.0f;
+    ALLEGRO_COLOR white = al_map_rgb(255, 255, 255);
+    ALLEGRO_COLOR grey = al_map_rgb(160, 160, 160);
+    float mn, avg, p99;
+
+    al_draw_filled_rectangle(x, y, x + PROFILER_PANEL_W, y + rows * lh + PROFILER_GRAPH_H + 20,
+                             al_map_rgba(0, 0, 0, 180));
+    x += 10.0f;
+    y += 5.0f;
+
+    /* header: whole frame */
+    profiler_stats(prof->frame_history, n, &mn, &avg, &p99);
+    al_draw_textf(font, white, x, y, 0, "frame ms (%.0f fps)", avg > 0.0f ? 1.0f / avg : 0.0f);
+    al_draw_textf(font, white, col_min, y, ALLEGRO_ALIGN_RIGHT, "%.2f", mn * 1000.0f);
+    al_draw_textf(font, white, col_avg, y, ALLEGRO_ALIGN_RIGHT, "%.2f", avg * 1000.0f);
+    al_draw_textf(font, white, col_p99, y, ALLEGRO_ALIGN_RIGHT, "%.2f", p99 * 1000.0f);
+    y += lh;
+    al_draw_text(font, grey, col_min, y, ALLEGRO_ALIGN_RIGHT, "min");
+    al_draw_text(font, grey, col_avg, y, ALLEGRO_ALIGN_RIGHT, "avg");
+    al_draw_text(font, grey, col_p99, y, ALLEGRO_ALIGN_RIGHT, "p99");
+    y += lh;
+
+    /* phases, CPU ms */
+    for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+        profiler_stats(prof->phase_history[p], n, &mn, &avg, &p99);
+        al_draw_text(font, white, x, y, 0, profiler_phase_name(p));
+        al_draw_textf(font, white, col_min, y, ALLEGRO_ALIGN_RIGHT, "%.3f", mn * 1000.0f);
+        al_draw_textf(font, white, col_avg, y, ALLEGRO_ALIGN_RIGHT, "%.3f", avg * 1000.0f);
+        al_draw_textf(font, white, col_p99, y, ALLEGRO_ALIGN_RIGHT, "%.3f", p99 * 1000.0f);
+        y += lh;
+    }
+
+    /* counters, last frame and average, under their own header */
+    al_draw_text(font, grey, col_avg, y, ALLEGRO_ALIGN_RIGHT, "last");
+    al_draw_text(font, grey, col_p99, y, ALLEGRO_ALIGN_RIGHT, "avg");
+    y += lh;
+    int last = (prof->head + PROFILER_HISTORY - 1) % PROFILER_HISTORY;
+    for (int c = 0; c < PROF_COUNTER_COUNT; c++) {
+        long int sum = 0;
+        for (int i = 0; i < n; i++) sum += prof->counter_history[c][i];
+        al_draw_text(font, grey, x, y, 0, profiler_counter_name(c));
+        al_draw_textf(font, grey, col_avg, y, ALLEGRO_ALIGN_RIGHT, "%d", prof->counter_history[c][last]);
+        al_draw_textf(font, grey, col_p99, y, ALLEGRO_ALIGN_RIGHT, "%.1f", (float)sum / (float)n);
+        y += lh;
+    }
+
+    /* frame time graph, oldest on the left, with the 60 fps line */
+    y += 5.0f;
+    float gw = (float)(PROFILER_PANEL_W - 20);
+    float bar_w = gw / (float)PROFILER_HISTORY;
+    float bottom = y + PROFILER_GRAPH_H;
+    for (int i = 0; i < n; i++) {
+        int slot = (prof->head + PROFILER_HISTORY - n + i) % PROFILER_HISTORY;
+        float t = prof->frame_history[slot];
+        float h = t / PROFILER_GRAPH_MAX;
+        if (h > 1.0f) h = 1.0f;
+        ALLEGRO_COLOR col = t > 1.0f / 30.0f ? al_map_rgb(255, 60, 60) : (t > 1.0f / 60.0f ? al_map_rgb(255, 200, 0) : al_map_rgb(60, 220, 60));
+        float bx = x + (float)(PROFILER_HISTORY - n + i) * bar_w;
+        al_draw_filled_rectangle(bx, bottom - h * PROFILER_GRAPH_H, bx + bar_w, bottom, col);
+    }
+    float y60 = bottom - (1.0f / 60.0f) / PROFILER_GRAPH_MAX * PROFILER_GRAPH_H;
+    al_draw_line(x, y60, x + gw, y60, grey, 1.0f);
+}
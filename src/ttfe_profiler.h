@@ -0,0 +1,86 @@
+/**\file ttfe_profiler.h
+ *  in game profiler: CPU time of each phase of the main loop, draw counters and a frame time graph
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#ifndef TTFE_PROFILER_HEADER_FOR_HACKS
+#define TTFE_PROFILER_HEADER_FOR_HACKS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_font.h>
+
+/* number of frames kept for the rolling stats and the graph */
+#define PROFILER_HISTORY 240
+
+/* timed phases of a frame, in loop order */
+typedef enum {
+    PROF_EVENTS = 0, /* event pump */
+    PROF_LOGIC,      /* logic ticks run since the last frame */
+    PROF_STARFIELD, /* clear, projection, camera and frustum, then the starfield */
+    PROF_LEVEL,
+    PROF_OVERLAY, /* glow recolor of letters and goals */
+    PROF_PINK_LIGHTS,
+    PROF_BOXES,
+    PROF_PARTICLES,
+    PROF_PROJECTILES,
+    PROF_HUD,
+    PROF_FLIP, /* al_flip_display */
+    PROF_PHASE_COUNT
+} ProfilerPhase;
+
+/* per frame counters */
+typedef enum {
+    PROF_COUNTER_DRAW_CALLS = 0,
+    PROF_COUNTER_VERTICES, /* vertices and indices uploaded */
+    PROF_COUNTER_TICKS,    /* logic ticks */
+    PROF_COUNTER_CHUNKS,   /* level chunks in the frustum */
+    PROF_COUNTER_ORPHANS,  /* full stream ring buffers replaced */
+    PROF_COUNTER_COUNT
+} ProfilerCounter;
+
+typedef struct {
+    bool enabled;
+    double mark;        /* end of the last measured span */
+    double frame_start; /* previous profiler_frame_end */
+    int head;           /* next history slot */
+    int filled;         /* valid history slots */
+
+    float current[PROF_PHASE_COUNT]; /* seconds spent in the running frame */
+    int current_counters[PROF_COUNTER_COUNT];
+
+    float phase_history[PROF_PHASE_COUNT][PROFILER_HISTORY];
+    float frame_history[PROFILER_HISTORY]; /* seconds between two frame ends */
+    int counter_history[PROF_COUNTER_COUNT][PROFILER_HISTORY];
+} Profiler;
+
+/* name of a ProfilerPhase */
+const char* profiler_phase_name(int phase);
+/* name of a ProfilerCounter */
+const char* profiler_counter_name(int counter);
+/* init a disabled profiler */
+void profiler_init(Profiler* prof);
+/* enable or disable, the history is restarted when enabling */
+void profiler_toggle(Profiler* prof);
+/* start a measured span, time since the last mark is not counted */
+void profiler_start(Profiler* prof);
+/* add the time since the last mark to phase, and restart the span */
+void profiler_mark(Profiler* prof, int phase);
+/* add n to a counter of the running frame */
+void profiler_count(Profiler* prof, int counter, int n);
+/* close the running frame: store it in the history with the VBO draw stats, which are cleared */
+void profiler_frame_end(Profiler* prof);
+/* draw the stats table and the frame time graph, top right of a dw wide screen */
+void profiler_draw(const Profiler* prof, ALLEGRO_FONT* font, int dw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
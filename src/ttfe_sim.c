@@ -0,0 +1,314 @@
+/**\file ttfe_sim.c
+ *  game logic tick, shared by the game loop and the headless bench
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#include "ttfe_sim.h"
+#include "ttfe_particles.h"
+
+static const char* sim_phase_names[SIM_PHASE_COUNT] = {
+    "player",
+    "obstacles",
+    "projectiles",
+    "lights",
+    "particles"};
+
+/* name of a SimPhase */
+const char* sim_phase_name(int phase) {
+    if (phase < 0 || phase >= SIM_PHASE_COUNT) return "?";
+    return sim_phase_names[phase];
+}
+
+/* reset the per level state */
+void sim_level_start(SimState* sim) {
+    sim->boxes_hit = 0;
+    sim->time_bonus_boxes = 0;
+    sim->speed_bonus_boxes = 0;
+    sim->time_over = false;
+    sim->fell_out = false;
+    sim->was_above_top = true;
+    sim->save_jump_available = false;
+    sim->score_counted = false;
+    sim->particles_moved = false;
+}
+
+/* jump, or save jump when just off a ledge. Returns true if the jump sound should be played */
+bool sim_jump(GameContext* ctx, SimState* sim, float jump_vel) {
+    if (ctx->on_ground) {
+        ctx->vertical_vel = jump_vel;
+        ctx->on_ground = false;
+        return true;
+    }
+    if (sim->save_jump_available) {
+        float bottom = ctx->cam.position.y - ctx->cam_half_height;
+        if (bottom > SIM_SAVE_JUMP_MIN_Y) {
+            ctx->vertical_vel = jump_vel;
+        }
+        sim->save_jump_available = false;
+        return true;
+    }
+    return false;
+}
+
+/* add the time since *t to phase, and restart *t */
+static void sim_phase_end(double* phase_time, int phase, double* t) {
+    if (!phase_time) return;
+    double now = al_get_time();
+    phase_time[phase] += now - *t;
+    *t = now;
+}
+
+/* spawn and move the obstacles. Returns the push they give to the player */
+static Vec3 sim_update_obstacles(GameContext* ctx, SimState* sim, const SimParams* params, float dt) {
+    Vec3 hit_move = v_make(0.0f, 0.0f, 0.0f);
+
+    /* Spawn Obstacles */
+    sim->obstacle_spawn_timer += dt;
+    if (sim->obstacle_spawn_timer >= params->obstacle_spawn_delay) {
+        sim->obstacle_spawn_timer = 0.0f;
+
+        /* Spawn at the end of the level geometry */
+        float end_x = ctx->vf.origin_x + ctx->vf.gw * ctx->vf.cell_size;
+        float z_span = ctx->vf.gh * ctx->vf.cell_size;
+
+        /* Random Z position within level width */
+        float spawn_z = ctx->vf.origin_z + frandf(0.0f, z_span);
+
+        /* Random Size */
+        float size = frandf(2.5f, 6.0f);
+
+        GameEntity* obs = pool_alloc(&ctx->boxes);
+        if (obs) {
+            /* speed (negative X) */
+            Vec3 vel = v_make(-frandf(20.0f, 60.0f), 0.0f, 0.0f);
+            /* Y over the surface of the letters */
+            Vec3 pos = v_make(end_x, ctx->vf.extrude_h + size, spawn_z);
+            entity_init_obstacle(obs, pos, vel, size);
+        }
+    }
+
+    /* Update boxes and boxes collisions */
+    /* backwards: releasing swaps the last active box in */
+    for (int k = ctx->boxes.count - 1; k >= 0; --k) {
+        GameEntity* box = &ctx->boxes.entities[ctx->boxes.active[k]];
+        if (!(box->flags & ENTITY_FLAG_OBSTACLE)) continue;
+
+        /* Box move */
+        box->prev_pos = box->pos;
+        box->pos = v_add(box->pos, v_scale(box->vel, dt));
+
+        /* collision */
+        if (capsule_aabb_collides(ctx->cam.position, ctx->cam_radius, ctx->cam_half_height, box->pos, box->size)) {
+            /* add box move to player */
+            hit_move.x += box->vel.x * dt;
+            /* Feedback effects (optional) */
+            ctx->cam.pitch += frandf(-0.02f, 0.02f);
+            ctx->cam.yaw += frandf(-0.02f, 0.02f);
+        }
+
+        /* if bump box is out of the map, kill it */
+        if (box->pos.x < ctx->vf.origin_x - 30.0f) {
+            pool_release(&ctx->boxes, box);
+        }
+    }
+    return hit_move;
+}
+
+/* move the player by disp + hit_move against the level, then check for fall and goal. Returns SIM_EVENT_* flags */
+static int sim_move_player(GameContext* ctx, SimState* sim, Vec3 disp, Vec3 hit_move, bool prev_on_ground) {
+    int events = 0;
+    Vec3 pos = ctx->cam.position;
+
+    /* X axis, swept so fast moves can't go through thin letters */
+    Vec3 test_pos = pos;
+    test_pos.x += disp.x + hit_move.x;
+    if (capsule_sweep(&ctx->vf, pos, test_pos, ctx->cam_radius, ctx->cam_half_height) >= 1.0f) {
+        pos.x = test_pos.x;
+    }
+
+    /* Z axis */
+    test_pos = pos;
+    test_pos.z += disp.z + hit_move.z;
+    if (capsule_sweep(&ctx->vf, pos, test_pos, ctx->cam_radius, ctx->cam_half_height) >= 1.0f) {
+        pos.z = test_pos.z;
+    }
+
+    /* Y axis */
+    test_pos = pos;
+    test_pos.y += disp.y + hit_move.y;
+    if (!capsule_collides(&ctx->vf, test_pos, ctx->cam_radius, ctx->cam_half_height)) {
+        pos.y = test_pos.y;
+        if (ctx->gravity_enabled)
+            ctx->on_ground = false;
+    } else {
+        if (ctx->gravity_enabled) {
+            if (disp.y < 0.0f)
+                ctx->on_ground = true;
+            ctx->vertical_vel = 0.0f;
+        }
+    }
+
+    ctx->cam.position = pos;
+
+    /* Fall detection */
+    if (ctx->gravity_enabled) {
+        float bottom = ctx->cam.position.y - ctx->cam_half_height;
+
+        if (prev_on_ground && !ctx->on_ground) {
+            int gx, gy;
+            world_to_grid(&ctx->vf, ctx->cam.position.x, ctx->cam.position.z, &gx, &gy);
+            bool near_solid = false;
+            for (int dy = -1; dy <= 1 && !near_solid; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (is_solid(&ctx->vf, gx + dx, gy + dy)) {
+                        near_solid = true;
+                        break;
+                    }
+                }
+            }
+            sim->save_jump_available = (near_solid && bottom > SIM_SAVE_JUMP_MIN_Y);
+        }
+
+        if (ctx->on_ground)
+            sim->save_jump_available = false;
+
+        if (bottom > ctx->vf.extrude_h + 0.1f) {
+            sim->was_above_top = true;
+        } else if (sim->was_above_top && bottom < ctx->vf.extrude_h && ctx->vertical_vel < 0.0f) {
+            sim->was_above_top = false;
+            events |= SIM_EVENT_FALLING;
+        }
+
+        if (bottom < SIM_FALL_DEATH_Y && !sim->fell_out) {
+            sim->save_jump_available = false;
+            ctx->state = STATE_PARTY_END;
+            ctx->party_result = PARTY_FAILED;
+            sim->fell_out = true;
+            events |= SIM_EVENT_GAME_OVER;
+        }
+    }
+
+    /* Goal check */
+    if (ctx->gravity_enabled && ctx->on_ground && ctx->state == STATE_PLAY) {
+        int gx, gy;
+        world_to_grid(&ctx->vf, ctx->cam.position.x, ctx->cam.position.z, &gx, &gy);
+        if (voxel_cell(&ctx->vf, gx, gy) & VOXEL_GOAL) {
+            ctx->state = STATE_PARTY_END;
+            if (!sim->time_over && !sim->fell_out) {
+                ctx->party_result = PARTY_SUCCESS;
+            }
+            events |= SIM_EVENT_GOAL;
+
+            if (ctx->level_index != ctx->level_count - 1) {
+                ctx->state = STATE_LEVEL_END;
+            }
+
+            if (!sim->score_counted) {
+                ctx->total_score += ctx->score;
+                sim->score_counted = true;
+            }
+        }
+    }
+    return events;
+}
+
+/* run one logic tick. If phase_time is not NULL, the seconds spent in each SimPhase are added to it. Returns SIM_EVENT_* flags */
+int sim_tick(GameContext* ctx, SimState* sim, const SimParams* params, const SimInput* input, float dt, ALLEGRO_SAMPLE* sfx_hit_level, ALLEGRO_SAMPLE* sfx_hit_bonus, bool audio_ok, double* phase_time) {
+    int events = 0;
+    double t = phase_time ? al_get_time() : 0.0;
+
+    /* start of the tick, for render interpolation */
+    ctx->cam_prev_pos = ctx->cam.position;
+
+    /* Update timer */
+    if (ctx->state == STATE_PLAY && !ctx->paused) {
+        ctx->time_remaining -= dt;
+        if (ctx->time_remaining <= 0.0f && !sim->time_over) {
+            ctx->time_remaining = 0.0f;
+            ctx->state = STATE_PARTY_END;
+            sim->time_over = true;
+            ctx->party_result = PARTY_FAILED;
+            events |= SIM_EVENT_GAME_OVER;
+        }
+    }
+
+    /* Movement */
+    if (ctx->state == STATE_PLAY && !ctx->paused) {
+        Vec3 forward3 = camera_forward(&ctx->cam);
+        Vec3 right3 = camera_right(&ctx->cam);
+
+        ctx->move_forward = ctx->move_lateral = 0.0f;
+        if (input->forward)
+            ctx->move_forward += ctx->move_speed;
+        if (input->back)
+            ctx->move_forward -= ctx->move_speed;
+        if (input->right)
+            ctx->move_lateral += ctx->move_speed;
+        if (input->left)
+            ctx->move_lateral -= ctx->move_speed;
+
+        bool prev_on_ground = ctx->on_ground;
+        Vec3 disp = v_zero();
+
+        if (ctx->gravity_enabled) {
+            Vec3 forward_flat = v_normalize(v_make(forward3.x, 0.0f, forward3.z));
+            Vec3 right_flat = v_normalize(v_make(right3.x, 0.0f, right3.z));
+
+            disp = v_add(disp, v_scale(forward_flat, ctx->move_forward));
+            disp = v_add(disp, v_scale(right_flat, ctx->move_lateral));
+
+            ctx->vertical_vel += params->gravity * dt;
+            disp.y += ctx->vertical_vel * dt;
+        } else {
+            disp = v_add(disp, v_scale(forward3, ctx->move_forward));
+            disp = v_add(disp, v_scale(right3, ctx->move_lateral));
+
+            if (input->up)
+                disp.y += ctx->move_speed;
+        }
+        sim_phase_end(phase_time, SIM_PHASE_PLAYER, &t);
+
+        /* Update obstacles */
+        Vec3 hit_move = sim_update_obstacles(ctx, sim, params, dt);
+        sim_phase_end(phase_time, SIM_PHASE_OBSTACLES, &t);
+
+        if (v_norm(disp) > 1e-5f) {
+            events |= sim_move_player(ctx, sim, disp, hit_move, prev_on_ground);
+        }
+    } else {
+        /* frozen boxes: nothing to interpolate, or they would shake with the render alpha */
+        for (int k = 0; k < ctx->boxes.count; ++k) {
+            GameEntity* box = &ctx->boxes.entities[ctx->boxes.active[k]];
+            box->prev_pos = box->pos;
+        }
+    }
+    sim_phase_end(phase_time, SIM_PHASE_PLAYER, &t);
+
+    /* Update projectiles */
+    update_projectiles(ctx, dt, sfx_hit_level, sfx_hit_bonus, audio_ok,
+                       &sim->boxes_hit, &sim->time_bonus_boxes, &sim->speed_bonus_boxes,
+                       params->speed_bonus_increment, params->speed_max_limit);
+    sim_phase_end(phase_time, SIM_PHASE_PROJECTILES, &t);
+
+    /* Update moving pink lights */
+    update_pink_lights(ctx, dt);
+    sim_phase_end(phase_time, SIM_PHASE_LIGHTS, &t);
+
+    /* Celebration particles */
+    if (ctx->state == STATE_PARTY_END && ctx->party_result == PARTY_SUCCESS) {
+        spawn_celebration_particles(ctx);
+    }
+
+    /* Update particles */
+    sim->particles_moved = (ctx->state == STATE_PLAY && !ctx->paused) ||
+                           ctx->state == STATE_LEVEL_END ||
+                           (ctx->state == STATE_PARTY_END && ctx->party_result == PARTY_SUCCESS);
+    if (sim->particles_moved) {
+        update_particles(ctx, params->gravity, dt);
+    }
+    sim_phase_end(phase_time, SIM_PHASE_PARTICLES, &t);
+
+    return events;
+}
@@ -0,0 +1,87 @@
+/**\file ttfe_sim.h
+ *  game logic tick, shared by the game loop and the headless bench
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 20/12/2025
+ */
+
+#ifndef TTFE_SIM_HEADER_FOR_HACKS
+#define TTFE_SIM_HEADER_FOR_HACKS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <allegro5/allegro.h>
+#include <allegro5/allegro_audio.h>
+
+#include "ttfe_game_context.h"
+
+/* player bottom under which the level is lost */
+#define SIM_FALL_DEATH_Y -10.0f
+/* player bottom over which a save jump is still allowed */
+#define SIM_SAVE_JUMP_MIN_Y -5.0f
+/* seconds between two obstacle spawns, for the game and the bench */
+#define SIM_OBSTACLE_SPAWN_DELAY 4.0f
+
+/* timed phases of a tick */
+typedef enum {
+    SIM_PHASE_PLAYER = 0, /* timer, movement, capsule collisions, fall and goal checks */
+    SIM_PHASE_OBSTACLES,  /* obstacle spawn and moves */
+    SIM_PHASE_PROJECTILES,
+    SIM_PHASE_LIGHTS,
+    SIM_PHASE_PARTICLES,
+    SIM_PHASE_COUNT
+} SimPhase;
+
+/* events of a tick, the caller plays the matching sounds */
+#define SIM_EVENT_GAME_OVER 0x01 /* time over or fell out */
+#define SIM_EVENT_FALLING 0x02   /* dropped under the top of the letters */
+#define SIM_EVENT_GOAL 0x04      /* goal reached */
+
+/* tuning, from the app config */
+typedef struct {
+    float gravity;
+    float speed_bonus_increment;
+    float speed_max_limit;
+    float obstacle_spawn_delay;
+} SimParams;
+
+/* held movement keys */
+typedef struct {
+    bool forward;
+    bool back;
+    bool left;
+    bool right;
+    bool up; /* fly up when gravity is disabled */
+} SimInput;
+
+typedef struct {
+    float obstacle_spawn_timer; /* kept across levels */
+
+    /* per level, reset by sim_level_start */
+    int boxes_hit;
+    int time_bonus_boxes;
+    int speed_bonus_boxes;
+    bool time_over;
+    bool fell_out;
+    bool was_above_top;
+    bool save_jump_available;
+    bool score_counted;
+    bool particles_moved; /* particles integrated on the last tick, else drawn without extrapolation */
+} SimState;
+
+/* name of a SimPhase */
+const char* sim_phase_name(int phase);
+/* reset the per level state */
+void sim_level_start(SimState* sim);
+/* jump, or save jump when just off a ledge. Returns true if the jump sound should be played */
+bool sim_jump(GameContext* ctx, SimState* sim, float jump_vel);
+/* run one logic tick. If phase_time is not NULL, the seconds spent in each SimPhase are added to it. Returns SIM_EVENT_* flags */
+int sim_tick(GameContext* ctx, SimState* sim, const SimParams* params, const SimInput* input, float dt, ALLEGRO_SAMPLE* sfx_hit_level, ALLEGRO_SAMPLE* sfx_hit_bonus, bool audio_ok, double* phase_time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
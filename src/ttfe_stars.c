@@ -5,7 +5,13 @@
  *\date 18/12/2025
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
 #include "ttfe_stars.h"
+#include "ttfe_game_context.h"
+#include "nilorea/n_log.h"
 
 /* Generate starfield into entity pool */
 void generate_starfield(EntityPool* pool, int count, float min_r, float max_r) {
@@ -30,81 +36,179 @@ void generate_starfield(EntityPool* pool, int count, float min_r, float max_r) {
     }
 }
 
-/* Render stars with twinkling effect */
-void render_starfield(const EntityPool* pool, VertexArray* va, float light_phase) {
-    va_clear(va);
+/* Generate the starfield around a level: a shell just outside the level footprint, denser for longer phrases */
+void generate_level_starfield(EntityPool* pool, const VoxelField* vf, int phrase_len) {
+    float level_w = vf->gw * vf->cell_size;
+    float level_d = vf->gh * vf->cell_size;
+    float level_radius = 0.5f * sqrtf(level_w * level_w + level_d * level_d);
+    float min_r = level_radius + 50.0f;
+    float max_r = level_radius + 250.0f;
+
+    int star_count = 128 + 120 * phrase_len;
+    if (star_count > STAR_COUNT) star_count = STAR_COUNT;
+    generate_starfield(pool, star_count, min_r, max_r);
+}
 
-    for (int i = 0; i < pool->capacity; ++i) {
-        const GameEntity* star = &pool->entities[i];
-        if (!entity_is_active(star)) continue;
+/* twinkle in the vertex shader: brightness from the phase in u and the ttfe_twinkle angle */
+static const char* starfield_vertex_shader_source =
+    "attribute vec4 al_pos;\n"
+    "attribute vec4 al_color;\n"
+    "attribute vec2 al_texcoord;\n"
+    "uniform mat4 al_projview_matrix;\n"
+    "uniform float ttfe_twinkle;\n"
+    "varying vec4 varying_color;\n"
+    "varying vec2 varying_texcoord;\n"
+    "void main() {\n"
+    "    float s = 1.0 + 0.4 * sin(ttfe_twinkle + al_texcoord.x);\n"
+    "    varying_color = vec4(min(al_color.rgb * s, 1.0), al_color.a);\n"
+    "    varying_texcoord = vec2(0.0, 0.0);\n"
+    "    gl_Position = al_projview_matrix * al_pos;\n"
+    "}\n";
+
+/* allocate a starfield mesh for capacity stars, CPU path until starfield_mesh_init_shader */
+void starfield_mesh_init(StarfieldMesh* sm, int capacity) {
+    memset(sm, 0, sizeof(StarfieldMesh));
+    va_init(&sm->va, capacity * 4);
+    sm->base = (ALLEGRO_COLOR*)calloc((size_t)capacity, sizeof(ALLEGRO_COLOR));
+    sm->phase_cos = (float*)calloc((size_t)capacity * 2, sizeof(float));
+    sm->phase_sin = sm->phase_cos ? sm->phase_cos + capacity : NULL;
+    sm->capacity = (sm->base && sm->phase_cos) ? capacity : 0;
+}
 
-        unsigned char r, g, b;
-        al_unmap_rgb(star->color, &r, &g, &b);
+/* free the mesh, its buffer and its shader */
+void starfield_mesh_free(StarfieldMesh* sm) {
+    va_free(&sm->va);
+    ttfe_vbo_destroy(&sm->vbo);
+    if (sm->shader) al_destroy_shader(sm->shader);
+    free(sm->base);
+    free(sm->phase_cos); /* start of the cos and sin block */
+    memset(sm, 0, sizeof(StarfieldMesh));
+}
 
-        /* twinkling */
-        float k = 0.5f + 0.5f * sinf(light_phase * 2.0f + star->phase);
-        float s = 0.6f + 0.8f * k;
+/* build the twinkle shader, once after al_create_display. Returns false if the CPU path is kept */
+bool starfield_mesh_init_shader(StarfieldMesh* sm) {
+    ALLEGRO_DISPLAY* display = al_get_current_display();
+    if (!display || !(al_get_display_flags(display) & ALLEGRO_PROGRAMMABLE_PIPELINE))
+        return false;
+
+    ALLEGRO_SHADER* shader = al_create_shader(ALLEGRO_SHADER_GLSL);
+    if (!shader) return false;
+
+    if (!al_attach_shader_source(shader, ALLEGRO_VERTEX_SHADER, starfield_vertex_shader_source) ||
+        !al_attach_shader_source(shader, ALLEGRO_PIXEL_SHADER,
+                                 al_get_default_shader_source(ALLEGRO_SHADER_GLSL, ALLEGRO_PIXEL_SHADER)) ||
+        !al_build_shader(shader)) {
+        n_log(LOG_ERR, "starfield shader not available: %s", al_get_shader_log(shader));
+        al_destroy_shader(shader);
+        return false;
+    }
+    sm->shader = shader;
+    return true;
+}
 
-        int ri = (int)(r * s);
-        if (ri > 255) ri = 255;
-        int gi = (int)(g * s);
-        if (gi > 255) gi = 255;
-        int bi = (int)(b * s);
-        if (bi > 255) bi = 255;
+/* bake the stars of pool into the mesh, and upload it for the shader path */
+void starfield_mesh_build(StarfieldMesh* sm, const EntityPool* pool) {
+    va_clear(&sm->va);
+    sm->star_count = 0;
 
-        ALLEGRO_COLOR c = al_map_rgb(ri, gi, bi);
+    for (int k = 0; k < pool->count && sm->star_count < sm->capacity; ++k) {
+        const GameEntity* star = &pool->entities[pool->active[k]];
+        int i = sm->star_count++;
+
+        sm->base[i] = star->color;
+        sm->phase_cos[i] = cosf(star->phase);
+        sm->phase_sin[i] = sinf(star->phase);
 
         float size = star->size;
-        float x = star->pos.x;
-        float y = star->pos.y;
+        float x0 = star->pos.x - size, x1 = star->pos.x + size;
+        float y0 = star->pos.y - size, y1 = star->pos.y + size;
         float z = star->pos.z;
+        float u = star->phase;
+        ALLEGRO_COLOR c = star->color;
 
-        float x0 = x - size, x1 = x + size;
-        float y0 = y - size, y1 = y + size;
+        va_reserve(&sm->va, 4);
+        ALLEGRO_VERTEX* v = sm->va.v + sm->va.count;
 
-        va_reserve(va, 6);
-        ALLEGRO_VERTEX* v = va->v + va->count;
+        v[0] = (ALLEGRO_VERTEX){x0, y0, z, u, 0, c};
+        v[1] = (ALLEGRO_VERTEX){x1, y0, z, u, 0, c};
+        v[2] = (ALLEGRO_VERTEX){x1, y1, z, u, 0, c};
+        v[3] = (ALLEGRO_VERTEX){x0, y1, z, u, 0, c};
 
-        v[0] = (ALLEGRO_VERTEX){x0, y0, z, 0, 0, c};
-        v[1] = (ALLEGRO_VERTEX){x1, y0, z, 0, 0, c};
-        v[2] = (ALLEGRO_VERTEX){x1, y1, z, 0, 0, c};
-        v[3] = (ALLEGRO_VERTEX){x0, y0, z, 0, 0, c};
-        v[4] = (ALLEGRO_VERTEX){x1, y1, z, 0, 0, c};
-        v[5] = (ALLEGRO_VERTEX){x0, y1, z, 0, 0, c};
+        va_add_quad_indices(&sm->va, sm->va.count);
+        sm->va.count += 4;
+    }
+
+    /* shader path: upload once, draw from the static buffer */
+    ttfe_vbo_destroy(&sm->vbo);
+    if (sm->shader && !vbo_upload_static(&sm->vbo, &sm->va)) {
+        n_log(LOG_ERR, "no static buffer for the starfield, twinkling it on the CPU");
+    }
+}
 
-        va->count += 6;
+/* CPU path: set the twinkled vertex colors for light_phase */
+void starfield_mesh_twinkle(StarfieldMesh* sm, float light_phase) {
+    /* sin(a + phase) from the baked cos and sin of the phase */
+    float a = light_phase * 2.0f;
+    float sa = sinf(a), ca = cosf(a);
+    ALLEGRO_VERTEX* v = sm->va.v;
+
+    for (int i = 0; i < sm->star_count; ++i, v += 4) {
+        float s = 1.0f + 0.4f * (sa * sm->phase_cos[i] + ca * sm->phase_sin[i]);
+        ALLEGRO_COLOR c = sm->base[i];
+        c.r = fminf(c.r * s, 1.0f);
+        c.g = fminf(c.g * s, 1.0f);
+        c.b = fminf(c.b * s, 1.0f);
+        v[0].color = v[1].color = v[2].color = v[3].color = c;
     }
 }
 
-/* Render pink lights with pulsing effect */
-void render_pink_lights(const EntityPool* pool, VertexArray* va, Vec3 cam_right, Vec3 cam_up, float light_phase) {
+/* draw the starfield twinkled for light_phase, the CPU path streams it through stream */
+void starfield_mesh_draw(StarfieldMesh* sm, TTFE_VBO* stream, float light_phase) {
+    if (sm->star_count == 0) return;
+
+    if (sm->shader && sm->vbo.vb) {
+        /* keep the angle small, shaders sin() are not precise on large values */
+        float twinkle = fmodf(light_phase * 2.0f, 6.2831853f);
+        al_use_shader(sm->shader);
+        al_set_shader_float("ttfe_twinkle", twinkle);
+        ttfe_vbo_draw_static(&sm->vbo, ALLEGRO_PRIM_TRIANGLE_LIST);
+        al_use_shader(NULL);
+        return;
+    }
+
+    starfield_mesh_twinkle(sm, light_phase);
+    vbo_draw(stream, &sm->va, ALLEGRO_PRIM_TRIANGLE_LIST);
+}
+
+/* Render pink lights in the frustum (all if NULL) with pulsing effect, alpha is the interpolation factor between the last two ticks */
+void render_pink_lights(const EntityPool* pool, VertexArray* va, const Frustum* frustum, Vec3 cam_right, Vec3 cam_up, float light_phase, float alpha) {
     va_clear(va);
 
-    for (int i = 0; i < pool->capacity; ++i) {
-        const GameEntity* light = &pool->entities[i];
-        if (!entity_is_active(light)) continue;
+    for (int k = 0; k < pool->count; ++k) {
+        const GameEntity* light = &pool->entities[pool->active[k]];
+        Vec3 pos = entity_render_pos(light, alpha);
+        if (frustum && !frustum_sphere_visible(frustum, pos, light->size)) continue;
 
-        float k = 0.5f + 0.5f * sinf(light_phase * 3.0f + light->phase);
-        float size = light->size * (0.6f + 0.4f * k);
+        float pulse = 0.5f + 0.5f * sinf(light_phase * 3.0f + light->phase);
+        float size = light->size * (0.6f + 0.4f * pulse);
 
         Vec3 right = v_scale(cam_right, size);
         Vec3 up = v_scale(cam_up, size);
 
-        Vec3 p0 = v_add(light->pos, v_add(v_scale(right, -1.0f), v_scale(up, -1.0f)));
-        Vec3 p1 = v_add(light->pos, v_add(right, v_scale(up, -1.0f)));
-        Vec3 p2 = v_add(light->pos, v_add(right, up));
-        Vec3 p3 = v_add(light->pos, v_add(v_scale(right, -1.0f), up));
+        Vec3 p0 = v_add(pos, v_add(v_scale(right, -1.0f), v_scale(up, -1.0f)));
+        Vec3 p1 = v_add(pos, v_add(right, v_scale(up, -1.0f)));
+        Vec3 p2 = v_add(pos, v_add(right, up));
+        Vec3 p3 = v_add(pos, v_add(v_scale(right, -1.0f), up));
 
-        va_reserve(va, 6);
+        va_reserve(va, 4);
         ALLEGRO_VERTEX* v = va->v + va->count;
 
         v[0] = (ALLEGRO_VERTEX){p0.x, p0.y, p0.z, 0, 0, light->color};
         v[1] = (ALLEGRO_VERTEX){p1.x, p1.y, p1.z, 0, 0, light->color};
         v[2] = (ALLEGRO_VERTEX){p2.x, p2.y, p2.z, 0, 0, light->color};
-        v[3] = (ALLEGRO_VERTEX){p0.x, p0.y, p0.z, 0, 0, light->color};
-        v[4] = (ALLEGRO_VERTEX){p2.x, p2.y, p2.z, 0, 0, light->color};
-        v[5] = (ALLEGRO_VERTEX){p3.x, p3.y, p3.z, 0, 0, light->color};
+        v[3] = (ALLEGRO_VERTEX){p3.x, p3.y, p3.z, 0, 0, light->color};
 
-        va->count += 6;
+        va_add_quad_indices(va, va->count);
+        va->count += 4;
     }
 }
@@ -13,15 +13,46 @@ extern "C" {
 #endif
 
 #include "ttfe_entities.h"
+#include "ttfe_vbo.h"
+
+/*
+ * Starfield baked once per level. Each star quad keeps its twinkle phase in
+ * the u texture coordinate: with a programmable pipeline the quads live in a
+ * static buffer and the twinkle runs in a vertex shader, else only the vertex
+ * colors are updated each frame, from a compact per star array.
+ */
+typedef struct {
+    VertexArray va;        /* star quads */
+    TTFE_VBO vbo;          /* static copy of va, shader path only */
+    ALLEGRO_SHADER* shader; /* twinkle shader, NULL for the CPU path */
+    ALLEGRO_COLOR* base;   /* CPU path: base color of each star */
+    float* phase_cos;      /* CPU path: cos and sin of each star phase */
+    float* phase_sin;
+    int star_count;
+    int capacity;
+} StarfieldMesh;
 
 /* Generate starfield into entity pool */
 void generate_starfield(EntityPool* pool, int count, float min_r, float max_r);
 
-/* Render stars with twinkling effect */
-void render_starfield(const EntityPool* pool, VertexArray* va, float light_phase);
-
-/* Render pink lights with pulsing effect */
-void render_pink_lights(const EntityPool* pool, VertexArray* va, Vec3 cam_right, Vec3 cam_up, float light_phase);
+/* Generate the starfield around a level: a shell just outside the level footprint, denser for longer phrases */
+void generate_level_starfield(EntityPool* pool, const VoxelField* vf, int phrase_len);
+
+/* allocate a starfield mesh for capacity stars, CPU path until starfield_mesh_init_shader */
+void starfield_mesh_init(StarfieldMesh* sm, int capacity);
+/* free the mesh, its buffer and its shader */
+void starfield_mesh_free(StarfieldMesh* sm);
+/* build the twinkle shader, once after al_create_display. Returns false if the CPU path is kept */
+bool starfield_mesh_init_shader(StarfieldMesh* sm);
+/* bake the stars of pool into the mesh, and upload it for the shader path */
+void starfield_mesh_build(StarfieldMesh* sm, const EntityPool* pool);
+/* CPU path: set the twinkled vertex colors for light_phase */
+void starfield_mesh_twinkle(StarfieldMesh* sm, float light_phase);
+/* draw the starfield twinkled for light_phase, the CPU path streams it through stream */
+void starfield_mesh_draw(StarfieldMesh* sm, TTFE_VBO* stream, float light_phase);
+
+/* Render pink lights in the frustum (all if NULL) with pulsing effect, alpha is the interpolation factor between the last two ticks */
+void render_pink_lights(const EntityPool* pool, VertexArray* va, const Frustum* frustum, Vec3 cam_right, Vec3 cam_up, float light_phase, float alpha);
 
 #ifdef __cplusplus
 }
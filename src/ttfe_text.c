@@ -10,70 +10,151 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define TTFE_TEXT_MMAP
+#endif
+
 #include "nilorea/n_log.h"
 #include "ttfe_text.h"
 
-/* Generic text file loading */
-char** load_text_file_lines(const char* filename, int* out_count) {
-    FILE* f = fopen(filename, "r");
+/* read the whole file into a heap buffer with a '\0' after the last byte */
+static bool text_file_read(TextFile* tf, const char* filename) {
+    FILE* f = fopen(filename, "rb");
     if (!f) {
         n_log(LOG_ERR, "Cannot open text file '%s'", filename);
-        *out_count = 0;
-        return NULL;
+        return false;
     }
-
-    int capacity = 8;
-    int count = 0;
-    char** lines = (char**)malloc(sizeof(char*) * capacity);
-    if (!lines) {
+    long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+    if (size < 0 || fseek(f, 0, SEEK_SET) != 0) {
+        n_log(LOG_ERR, "Cannot get the size of '%s'", filename);
+        fclose(f);
+        return false;
+    }
+    tf->data = (char*)malloc((size_t)size + 1);
+    if (!tf->data) {
+        n_log(LOG_ERR, "malloc failed for '%s' (%ld bytes)", filename, size);
         fclose(f);
+        return false;
+    }
+    tf->size = fread(tf->data, 1, (size_t)size, f);
+    tf->data[tf->size] = '\0';
+    tf->mapped = false;
+    fclose(f);
+    return true;
+}
+
+#ifdef TTFE_TEXT_MMAP
+/* map the file copy on write. Returns false to fall back to text_file_read */
+static bool text_file_map(TextFile* tf, const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    /* the last line needs a writable byte after it for its '\0': past the end of
+     * the file in the last page, or its own line end. A file filling its last
+     * page without a final line end is read instead */
+    long page = sysconf(_SC_PAGESIZE);
+    size_t size = (size_t)st.st_size;
+    char* data = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    if (page > 0 && size % (size_t)page == 0 && data[size - 1] != '\n') {
+        munmap(data, size);
+        return false;
+    }
+
+    tf->data = data;
+    tf->size = size;
+    tf->mapped = true;
+    return true;
+}
+#endif
+
+/* Generic text file loading: map filename and index its non empty lines. Returns false if none */
+bool text_file_open(TextFile* tf, const char* filename) {
+    memset(tf, 0, sizeof(TextFile));
+
+#ifdef TTFE_TEXT_MMAP
+    if (!text_file_map(tf, filename))
+#endif
+        if (!text_file_read(tf, filename))
+            return false;
+
+    /* upper bound of the line count, for a single allocation */
+    int max_lines = 1;
+    for (const char* p = tf->data; (p = (const char*)memchr(p, '\n', tf->size - (size_t)(p - tf->data))); p++)
+        max_lines++;
+    tf->lines = (TextSpan*)malloc(sizeof(TextSpan) * (size_t)max_lines);
+    if (!tf->lines) {
         n_log(LOG_ERR, "malloc failed for lines of '%s'", filename);
-        *out_count = 0;
-        return NULL;
+        text_file_close(tf);
+        return false;
     }
 
-    char buffer[4096];
-    while (fgets(buffer, sizeof(buffer), f)) {
-        size_t len = strlen(buffer);
-        while (len > 0 && (buffer[len - 1] == '\n' || buffer[len - 1] == '\r')) {
-            buffer[--len] = '\0';
-        }
-        if (len == 0) {
-            continue; /* skip empty lines */
-        }
-        if (count >= capacity) {
-            capacity *= 2;
-            char** tmp = (char**)realloc(lines, sizeof(char*) * capacity);
-            if (!tmp) {
-                n_log(LOG_ERR, "realloc failed for lines of '%s'", filename);
-                for (int i = 0; i < count; ++i) free(lines[i]);
-                free(lines);
-                fclose(f);
-                *out_count = 0;
-                return NULL;
-            }
-            lines = tmp;
+    char* p = tf->data;
+    char* end = tf->data + tf->size;
+    while (p < end) {
+        char* eol = (char*)memchr(p, '\n', (size_t)(end - p));
+        if (!eol) eol = end; /* '\0' already there: past the end of the mapping or of the buffer */
+        size_t len = (size_t)(eol - p);
+        while (len > 0 && p[len - 1] == '\r') len--;
+        if (eol < end) *eol = '\0';
+        p[len] = '\0';
+        if (len > 0) {
+            tf->lines[tf->line_count].ptr = p;
+            tf->lines[tf->line_count].len = len;
+            tf->line_count++;
         }
-        char* line = strdup(buffer);
-        if (!line) {
-            n_log(LOG_ERR, "strdup failed for a line of '%s'", filename);
-            for (int i = 0; i < count; ++i) free(lines[i]);
-            free(lines);
-            fclose(f);
-            *out_count = 0;
-            return NULL;
-        }
-        lines[count++] = line;
+        p = eol + 1;
     }
-    fclose(f);
 
-    if (count == 0) {
+    if (tf->line_count == 0) {
         n_log(LOG_ERR, "No non-empty lines in '%s'", filename);
-        free(lines);
-        *out_count = 0;
-        return NULL;
+        text_file_close(tf);
+        return false;
     }
+    return true;
+}
 
-    *out_count = count;
-    return lines;
+/* Unmap a text file, its lines and tokens are no longer valid */
+void text_file_close(TextFile* tf) {
+#ifdef TTFE_TEXT_MMAP
+    if (tf->mapped && tf->data) munmap(tf->data, tf->size);
+#endif
+    if (!tf->mapped) free(tf->data);
+    free(tf->lines);
+    memset(tf, 0, sizeof(TextFile));
+}
+
+/* blank for the tokenizer, '\0' included so a span can be split again */
+static bool text_is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\0';
+}
+
+/* split span on blanks in place: each token gets a '\0' end. Returns the number of tokens, at most max_tokens */
+int text_span_tokens(TextSpan span, TextSpan* tokens, int max_tokens) {
+    int count = 0;
+    size_t i = 0;
+    while (count < max_tokens) {
+        while (i < span.len && text_is_blank(span.ptr[i])) i++;
+        if (i >= span.len) break;
+
+        size_t start = i;
+        while (i < span.len && !text_is_blank(span.ptr[i])) i++;
+        tokens[count].ptr = span.ptr + start;
+        tokens[count].len = i - start;
+        count++;
+        /* the span itself is '\0' ended, so span.ptr[span.len] is writable */
+        span.ptr[i] = '\0';
+    }
+    return count;
 }
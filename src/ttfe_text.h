@@ -12,8 +12,38 @@
 extern "C" {
 #endif
 
-/* Generic text file loading */
-char** load_text_file_lines(const char* filename, int* out_count);
+#include <stdbool.h>
+#include <stddef.h>
+
+/* tokens of a levels.txt line: phrase, COLOR_CYCLE_GOAL, PULSE_TEXT, BLEND_TEXT */
+#define LEVEL_LINE_TOKENS 4
+
+/* view of a line or a token inside a TextFile. ptr is also '\0' terminated */
+typedef struct {
+    char* ptr;
+    size_t len;
+} TextSpan;
+
+/*
+ * A whole text file in one private copy on write mapping (one heap buffer
+ * where mmap is not used). Line ends are replaced by '\0' in place, so
+ * lines are C strings pointing into the mapping: no per line allocation
+ * and no line length limit.
+ */
+typedef struct {
+    char* data;
+    size_t size;
+    bool mapped;     /* data from mmap, else from malloc */
+    TextSpan* lines; /* non empty lines, CR LF or LF ended */
+    int line_count;
+} TextFile;
+
+/* Generic text file loading: map filename and index its non empty lines. Returns false if none */
+bool text_file_open(TextFile* tf, const char* filename);
+/* Unmap a text file, its lines and tokens are no longer valid */
+void text_file_close(TextFile* tf);
+/* split span on blanks in place: each token gets a '\0' end. Returns the number of tokens, at most max_tokens */
+int text_span_tokens(TextSpan span, TextSpan* tokens, int max_tokens);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,93 @@
+/**\file ttfe_tint.c
+ *  per-draw color tint for static meshes (shader uniform or 1x1 texture)
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 19/12/2025
+ */
+
+#include "ttfe_tint.h"
+#include "nilorea/n_log.h"
+
+static const char* tint_pixel_shader_source =
+    "#ifdef GL_ES\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "uniform vec4 ttfe_tint;\n"
+    "varying vec4 varying_color;\n"
+    "void main() {\n"
+    "    gl_FragColor = varying_color * ttfe_tint;\n"
+    "}\n";
+
+/* build the tint shader, NULL if the display has no programmable pipeline */
+static ALLEGRO_SHADER* tint_create_shader(void) {
+    ALLEGRO_DISPLAY* display = al_get_current_display();
+    if (!display || !(al_get_display_flags(display) & ALLEGRO_PROGRAMMABLE_PIPELINE))
+        return NULL;
+
+    ALLEGRO_SHADER* shader = al_create_shader(ALLEGRO_SHADER_GLSL);
+    if (!shader) return NULL;
+
+    if (!al_attach_shader_source(shader, ALLEGRO_VERTEX_SHADER,
+                                 al_get_default_shader_source(ALLEGRO_SHADER_GLSL, ALLEGRO_VERTEX_SHADER)) ||
+        !al_attach_shader_source(shader, ALLEGRO_PIXEL_SHADER, tint_pixel_shader_source) ||
+        !al_build_shader(shader)) {
+        n_log(LOG_ERR, "tint shader not available: %s", al_get_shader_log(shader));
+        al_destroy_shader(shader);
+        return NULL;
+    }
+    return shader;
+}
+
+/* init once after al_create_display */
+bool ttfe_tint_init(TTFE_TINT* tint) {
+    tint->shader = tint_create_shader();
+    tint->texel = NULL;
+    if (tint->shader) return true;
+
+    tint->texel = al_create_bitmap(1, 1);
+    if (!tint->texel) {
+        n_log(LOG_ERR, "Failed to create tint texture");
+        return false;
+    }
+    return true;
+}
+
+/* shutdown at the end */
+void ttfe_tint_destroy(TTFE_TINT* tint) {
+    if (tint->shader) al_destroy_shader(tint->shader);
+    if (tint->texel) al_destroy_bitmap(tint->texel);
+    tint->shader = NULL;
+    tint->texel = NULL;
+}
+
+/* store color in the 1x1 fallback texture */
+static bool tint_set_texel(ALLEGRO_BITMAP* texel, ALLEGRO_COLOR color) {
+    ALLEGRO_LOCKED_REGION* lr = al_lock_bitmap(texel, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_WRITEONLY);
+    if (!lr) return false;
+
+    unsigned char* px = (unsigned char*)lr->data;
+    al_unmap_rgba(color, &px[0], &px[1], &px[2], &px[3]);
+    al_unlock_bitmap(texel);
+    return true;
+}
+
+/* set up the tint for the next draws, *texture being the texture to draw with. Returns false if there is no way to tint */
+bool ttfe_tint_begin(TTFE_TINT* tint, ALLEGRO_COLOR color, ALLEGRO_BITMAP** texture) {
+    *texture = NULL;
+    if (tint->shader) {
+        float c[4] = {color.r, color.g, color.b, color.a};
+        al_use_shader(tint->shader);
+        al_set_shader_float_vector("ttfe_tint", 4, c, 1);
+        return true;
+    }
+    if (tint->texel && tint_set_texel(tint->texel, color)) {
+        *texture = tint->texel;
+        return true;
+    }
+    return false; /* no way to tint, white meshes are worse than none */
+}
+
+/* end of the tinted draws */
+void ttfe_tint_end(TTFE_TINT* tint) {
+    if (tint->shader) al_use_shader(NULL);
+}
@@ -0,0 +1,41 @@
+/**\file ttfe_tint.h
+ *  per-draw color tint for static meshes (shader uniform or 1x1 texture)
+ *\author Castagnier Mickael aka Gull Ra Driel
+ *\version 1.0
+ *\date 19/12/2025
+ */
+
+#ifndef TTFE_TINT_HEADER_FOR_HACKS
+#define TTFE_TINT_HEADER_FOR_HACKS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ttfe_vector3d.h"
+
+/*
+ * Multiplies the vertex colors of a mesh by one color at draw time.
+ * With a programmable pipeline the color is a shader uniform, else the
+ * mesh is drawn textured with a 1x1 bitmap holding the color.
+ * Meshes drawn this way should have white vertex colors.
+ */
+typedef struct {
+    ALLEGRO_SHADER* shader; /* tint shader, NULL when not available */
+    ALLEGRO_BITMAP* texel;  /* 1x1 tint texture for the fallback path */
+} TTFE_TINT;
+
+/* init once after al_create_display */
+bool ttfe_tint_init(TTFE_TINT* tint);
+/* shutdown at the end */
+void ttfe_tint_destroy(TTFE_TINT* tint);
+/* set up the tint for the next draws, *texture being the texture to draw with. Returns false if there is no way to tint */
+bool ttfe_tint_begin(TTFE_TINT* tint, ALLEGRO_COLOR color, ALLEGRO_BITMAP** texture);
+/* end of the tinted draws */
+void ttfe_tint_end(TTFE_TINT* tint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,11 +5,93 @@
  *\date 11/12/2025
  */
 
+#include <stdlib.h>
+
 #include "ttfe_vbo.h"
 
+TTFE_VBO_STATS ttfe_vbo_stats = {0, 0, 0};
+
+/* count a draw issued without the helpers below (al_draw_prim and friends) */
+void ttfe_vbo_count_draw(int vertices_uploaded) {
+    ttfe_vbo_stats.draw_calls++;
+    ttfe_vbo_stats.vertices_uploaded += vertices_uploaded;
+}
+
+/* empty a ring of capacity elements, its high water mark is kept */
+static void ttfe_vbo_ring_reset(TTFE_VBO_RING* r, int capacity) {
+    int high_water = r->high_water;
+    memset(r, 0, sizeof(TTFE_VBO_RING));
+    r->capacity = capacity;
+    r->high_water = high_water;
+}
+
+/* take n contiguous elements, returns their offset or -1 if the frames in flight leave no room */
+static int ttfe_vbo_ring_alloc(TTFE_VBO_RING* r, int n) {
+    int live = 0;
+    for (int f = 0; f < TTFE_VBO_RING_FRAMES; f++) live += r->used[f];
+
+    int offset = r->head;
+    int taken = n;
+    if (r->head + n > r->capacity) {
+        /* wrap: the end of the buffer is padding of the running frame */
+        offset = 0;
+        taken += r->capacity - r->head;
+    }
+    if (taken > r->capacity - live) return -1;
+
+    r->head = offset + n;
+    r->used[r->frame] += taken;
+    if (r->used[r->frame] > r->high_water) r->high_water = r->used[r->frame];
+    return offset;
+}
+
+/* capacity holding every frame in flight at the running frame usage plus n */
+static int ttfe_vbo_ring_grown_capacity(const TTFE_VBO_RING* r, int n) {
+    int needed = (r->used[r->frame] + n) * TTFE_VBO_RING_FRAMES;
+    int cap = r->capacity > 0 ? r->capacity : 1024;
+    while (cap < needed) cap *= 2;
+    return cap;
+}
+
+/* take n vertices of a ring vbo. When full, the buffer is orphaned: a new one
+ * replaces it and the driver keeps the old storage until the GPU is done */
+static int ttfe_vbo_ring_take_vertices(TTFE_VBO* vbo, int n) {
+    int offset = vbo->vb ? ttfe_vbo_ring_alloc(&vbo->vertex_ring, n) : -1;
+    if (offset >= 0) return offset;
+
+    int cap = ttfe_vbo_ring_grown_capacity(&vbo->vertex_ring, n);
+    if (vbo->vb) al_destroy_vertex_buffer(vbo->vb);
+    vbo->vb = al_create_vertex_buffer(NULL, NULL, cap, ALLEGRO_PRIM_BUFFER_STREAM);
+    vbo->capacity = vbo->vb ? cap : 0;
+    ttfe_vbo_ring_reset(&vbo->vertex_ring, vbo->capacity);
+    ttfe_vbo_stats.ring_orphans++;
+    return vbo->vb ? ttfe_vbo_ring_alloc(&vbo->vertex_ring, n) : -1;
+}
+
+/* take n indices of a ring vbo, orphaning the index buffer when full */
+static int ttfe_vbo_ring_take_indices(TTFE_VBO* vbo, int n) {
+    int offset = vbo->ib ? ttfe_vbo_ring_alloc(&vbo->index_ring, n) : -1;
+    if (offset >= 0) return offset;
+
+    int cap = ttfe_vbo_ring_grown_capacity(&vbo->index_ring, n);
+    if (vbo->ib) al_destroy_index_buffer(vbo->ib);
+    vbo->index_size = 4;
+    vbo->ib = al_create_index_buffer(vbo->index_size, NULL, cap, ALLEGRO_PRIM_BUFFER_STREAM);
+    vbo->index_capacity = vbo->ib ? cap : 0;
+    ttfe_vbo_ring_reset(&vbo->index_ring, vbo->index_capacity);
+    ttfe_vbo_stats.ring_orphans++;
+    return vbo->ib ? ttfe_vbo_ring_alloc(&vbo->index_ring, n) : -1;
+}
+
 /* init once after al_create_display */
 void ttfe_vbo_init(TTFE_VBO* vbo, int initial_cap) {
     if (initial_cap < 1) initial_cap = 1;
+    vbo->ring = false;
+    memset(&vbo->vertex_ring, 0, sizeof(TTFE_VBO_RING));
+    memset(&vbo->index_ring, 0, sizeof(TTFE_VBO_RING));
+    vbo->ib = NULL;
+    vbo->index_capacity = 0;
+    vbo->index_size = 4;
     vbo->capacity = initial_cap;
     vbo->vb = al_create_vertex_buffer(
         NULL, /* layout standard ALLEGRO_VERTEX */
@@ -18,11 +100,39 @@ void ttfe_vbo_init(TTFE_VBO* vbo, int initial_cap) {
         ALLEGRO_PRIM_BUFFER_DYNAMIC);
 }
 
+/* init once after al_create_display, as a ring of vertex_cap vertices and index_cap indices */
+void ttfe_vbo_init_ring(TTFE_VBO* vbo, int vertex_cap, int index_cap) {
+    if (vertex_cap < 1) vertex_cap = 1;
+    if (index_cap < 1) index_cap = 1;
+    memset(vbo, 0, sizeof(TTFE_VBO));
+    vbo->ring = true;
+    vbo->index_size = 4;
+    vbo->vb = al_create_vertex_buffer(NULL, NULL, vertex_cap, ALLEGRO_PRIM_BUFFER_STREAM);
+    vbo->capacity = vbo->vb ? vertex_cap : 0;
+    vbo->ib = al_create_index_buffer(vbo->index_size, NULL, index_cap, ALLEGRO_PRIM_BUFFER_STREAM);
+    vbo->index_capacity = vbo->ib ? index_cap : 0;
+    ttfe_vbo_ring_reset(&vbo->vertex_ring, vbo->capacity);
+    ttfe_vbo_ring_reset(&vbo->index_ring, vbo->index_capacity);
+}
+
+/* start a new frame in a ring buffer, the space of the oldest frame in flight is reused */
+void ttfe_vbo_ring_frame(TTFE_VBO* vbo) {
+    if (!vbo->ring) return;
+    TTFE_VBO_RING* rings[2] = {&vbo->vertex_ring, &vbo->index_ring};
+    for (int i = 0; i < 2; i++) {
+        rings[i]->frame = (rings[i]->frame + 1) % TTFE_VBO_RING_FRAMES;
+        rings[i]->used[rings[i]->frame] = 0;
+    }
+}
+
 /* shutdown at the end */
 void ttfe_vbo_destroy(TTFE_VBO* vbo) {
     if (vbo->vb) al_destroy_vertex_buffer(vbo->vb);
     vbo->vb = NULL;
     vbo->capacity = 0;
+    if (vbo->ib) al_destroy_index_buffer(vbo->ib);
+    vbo->ib = NULL;
+    vbo->index_capacity = 0;
 }
 
 /* check vbo cpacity */
@@ -38,6 +148,19 @@ void ttfe_vbo_ensure(TTFE_VBO* vbo, int needed) {
     vbo->capacity = newcap;
 }
 
+/* check index buffer capacity */
+void ttfe_vbo_ensure_indices(TTFE_VBO* vbo, int needed) {
+    if (vbo->ib && needed <= vbo->index_capacity) return;
+
+    int newcap = vbo->index_capacity > 0 ? vbo->index_capacity : 1024;
+    while (newcap < needed) newcap *= 2;
+
+    if (vbo->ib) al_destroy_index_buffer(vbo->ib);
+    vbo->index_size = 4;
+    vbo->ib = al_create_index_buffer(vbo->index_size, NULL, newcap, ALLEGRO_PRIM_BUFFER_DYNAMIC);
+    vbo->index_capacity = vbo->ib ? newcap : 0;
+}
+
 /* draw from a VertexArray */
 void ttfe_vbo_draw(
     TTFE_VBO* vbo,
@@ -46,14 +169,147 @@ void ttfe_vbo_draw(
     int prim_type) {
     if (!verts || count <= 0) return;
 
+    /* ring: a fresh range, the GPU may still read the previous ones */
+    int first = 0;
+    if (vbo->ring) {
+        first = ttfe_vbo_ring_take_vertices(vbo, count);
+        if (first < 0) return;
+    } else {
+        ttfe_vbo_ensure(vbo, count);
+    }
+
+    void* dst = al_lock_vertex_buffer(
+        vbo->vb, first, count, ALLEGRO_LOCK_WRITEONLY);
+    if (!dst) return;
+
+    memcpy(dst, verts, sizeof(ALLEGRO_VERTEX) * count);
+    al_unlock_vertex_buffer(vbo->vb);
+
+    al_draw_vertex_buffer(vbo->vb, NULL, first, first + count, prim_type);
+    ttfe_vbo_count_draw(count);
+}
+
+/* indexed draw through the rings: indices are rebased on the vertex range, there is no base vertex in the draw call */
+static void ttfe_vbo_draw_indexed_ring(TTFE_VBO* vbo, const ALLEGRO_VERTEX* verts, int count, const int* indices, int index_count, int prim_type) {
+    int first = ttfe_vbo_ring_take_vertices(vbo, count);
+    int first_index = first >= 0 ? ttfe_vbo_ring_take_indices(vbo, index_count) : -1;
+    if (first < 0 || first_index < 0) {
+        /* no buffer support: let the primitives addon stream it */
+        al_draw_indexed_prim(verts, NULL, NULL, indices, index_count, prim_type);
+        ttfe_vbo_count_draw(count + index_count);
+        return;
+    }
+
+    void* dst = al_lock_vertex_buffer(
+        vbo->vb, first, count, ALLEGRO_LOCK_WRITEONLY);
+    if (!dst) return;
+    memcpy(dst, verts, sizeof(ALLEGRO_VERTEX) * count);
+    al_unlock_vertex_buffer(vbo->vb);
+
+    int* idst = (int*)al_lock_index_buffer(
+        vbo->ib, first_index, index_count, ALLEGRO_LOCK_WRITEONLY);
+    if (!idst) return;
+    for (int i = 0; i < index_count; i++) idst[i] = indices[i] + first;
+    al_unlock_index_buffer(vbo->ib);
+
+    al_draw_indexed_buffer(vbo->vb, NULL, vbo->ib, first_index, first_index + index_count, prim_type);
+    ttfe_vbo_count_draw(count + index_count);
+}
+
+/* draw from an indexed VertexArray */
+void ttfe_vbo_draw_indexed(
+    TTFE_VBO* vbo,
+    const ALLEGRO_VERTEX* verts,
+    int count,
+    const int* indices,
+    int index_count,
+    int prim_type) {
+    if (!verts || count <= 0 || !indices || index_count <= 0) return;
+
+    if (vbo->ring) {
+        ttfe_vbo_draw_indexed_ring(vbo, verts, count, indices, index_count, prim_type);
+        return;
+    }
+
     ttfe_vbo_ensure(vbo, count);
+    ttfe_vbo_ensure_indices(vbo, index_count);
+    if (!vbo->vb || !vbo->ib) {
+        /* no index buffer support: let the primitives addon stream it */
+        al_draw_indexed_prim(verts, NULL, NULL, indices, index_count, prim_type);
+        ttfe_vbo_count_draw(count + index_count);
+        return;
+    }
 
     void* dst = al_lock_vertex_buffer(
         vbo->vb, 0, count, ALLEGRO_LOCK_WRITEONLY);
     if (!dst) return;
-
     memcpy(dst, verts, sizeof(ALLEGRO_VERTEX) * count);
     al_unlock_vertex_buffer(vbo->vb);
 
-    al_draw_vertex_buffer(vbo->vb, NULL, 0, count, prim_type);
+    void* idst = al_lock_index_buffer(
+        vbo->ib, 0, index_count, ALLEGRO_LOCK_WRITEONLY);
+    if (!idst) return;
+    memcpy(idst, indices, sizeof(int) * index_count);
+    al_unlock_index_buffer(vbo->ib);
+
+    al_draw_indexed_buffer(vbo->vb, NULL, vbo->ib, 0, index_count, prim_type);
+    ttfe_vbo_count_draw(count + index_count);
+}
+
+/* upload vertices (and indices if any) once into static buffers, returns false if no buffer could be created */
+bool ttfe_vbo_create_static(TTFE_VBO* vbo, const ALLEGRO_VERTEX* verts, int count, const int* indices, int index_count) {
+    ttfe_vbo_destroy(vbo);
+    if (!verts || count <= 0) return false;
+
+    vbo->vb = al_create_vertex_buffer(NULL, verts, count, ALLEGRO_PRIM_BUFFER_STATIC);
+    if (!vbo->vb) return false;
+    vbo->capacity = count;
+    ttfe_vbo_stats.vertices_uploaded += count;
+
+    if (!indices || index_count <= 0) return true;
+
+    /* 16 bits indices whenever the vertex count allows it */
+    if (count <= 65536) {
+        unsigned short* idx16 = (unsigned short*)malloc(sizeof(unsigned short) * index_count);
+        if (idx16) {
+            for (int i = 0; i < index_count; i++) idx16[i] = (unsigned short)indices[i];
+            vbo->index_size = 2;
+            vbo->ib = al_create_index_buffer(2, idx16, index_count, ALLEGRO_PRIM_BUFFER_STATIC);
+            free(idx16);
+        }
+    }
+    if (!vbo->ib) {
+        vbo->index_size = 4;
+        vbo->ib = al_create_index_buffer(4, indices, index_count, ALLEGRO_PRIM_BUFFER_STATIC);
+    }
+    if (!vbo->ib) {
+        ttfe_vbo_destroy(vbo);
+        return false;
+    }
+    vbo->index_capacity = index_count;
+    ttfe_vbo_stats.vertices_uploaded += index_count;
+    return true;
+}
+
+/* draw a whole static buffer */
+void ttfe_vbo_draw_static(const TTFE_VBO* vbo, int prim_type) {
+    ttfe_vbo_draw_static_textured(vbo, NULL, prim_type);
+}
+
+/* draw a whole static buffer with a texture */
+void ttfe_vbo_draw_static_textured(const TTFE_VBO* vbo, ALLEGRO_BITMAP* texture, int prim_type) {
+    if (!vbo->vb || vbo->capacity <= 0) return;
+    ttfe_vbo_count_draw(0);
+    if (vbo->ib) {
+        al_draw_indexed_buffer(vbo->vb, texture, vbo->ib, 0, vbo->index_capacity, prim_type);
+        return;
+    }
+    al_draw_vertex_buffer(vbo->vb, texture, 0, vbo->capacity, prim_type);
+}
+
+/* draw count indices from first of an indexed static buffer, with an optional texture */
+void ttfe_vbo_draw_static_range(const TTFE_VBO* vbo, ALLEGRO_BITMAP* texture, int first, int count, int prim_type) {
+    if (!vbo->vb || !vbo->ib || count <= 0) return;
+    ttfe_vbo_count_draw(0);
+    al_draw_indexed_buffer(vbo->vb, texture, vbo->ib, first, first + count, prim_type);
 }
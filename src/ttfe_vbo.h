@@ -16,19 +16,68 @@ extern "C" {
 #include <allegro5/allegro_primitives.h>
 #include <string.h>
 
+/* frames the GPU may still be reading from a ring buffer: the swap chain depth */
+#define TTFE_VBO_RING_FRAMES 3
+
+/*
+ * Sub-allocation state of a ring buffer. Each draw takes the next free range,
+ * wrapping to 0 at the end, so it never overwrites data a previous draw of the
+ * last TTFE_VBO_RING_FRAMES frames may still use.
+ */
+typedef struct {
+    int capacity;
+    int head;                             /* next free element */
+    int frame;                            /* slot of the running frame in used */
+    int used[TTFE_VBO_RING_FRAMES];       /* elements taken by each frame in flight, wrap padding included */
+    int high_water;                       /* most elements taken in a single frame */
+} TTFE_VBO_RING;
+
 typedef struct {
     ALLEGRO_VERTEX_BUFFER* vb;
     int capacity;
+    ALLEGRO_INDEX_BUFFER* ib; /* companion index buffer, NULL until indexed draws */
+    int index_capacity;
+    int index_size; /* 2 or 4 bytes per index in ib */
+    bool ring;      /* ttfe_vbo_init_ring: dynamic draws sub-allocate instead of rewriting offset 0 */
+    TTFE_VBO_RING vertex_ring;
+    TTFE_VBO_RING index_ring;
 } TTFE_VBO;
 
+/* draw statistics, accumulated by the helpers below and cleared once per frame */
+typedef struct {
+    int draw_calls;
+    int vertices_uploaded; /* vertices and indices sent to the GPU */
+    int ring_orphans;      /* ring buffers replaced because they were full */
+} TTFE_VBO_STATS;
+
+extern TTFE_VBO_STATS ttfe_vbo_stats;
+
+/* count a draw issued without the helpers below (al_draw_prim and friends) */
+void ttfe_vbo_count_draw(int vertices_uploaded);
 /* init once after al_create_display */
 void ttfe_vbo_init(TTFE_VBO* vbo, int initial_cap);
+/* init once after al_create_display, as a ring of vertex_cap vertices and index_cap indices */
+void ttfe_vbo_init_ring(TTFE_VBO* vbo, int vertex_cap, int index_cap);
+/* start a new frame in a ring buffer, the space of the oldest frame in flight is reused */
+void ttfe_vbo_ring_frame(TTFE_VBO* vbo);
 /* shutdown at the end */
 void ttfe_vbo_destroy(TTFE_VBO* vbo);
 /* check vbo cpacity */
 void ttfe_vbo_ensure(TTFE_VBO* vbo, int needed);
+/* check index buffer capacity */
+void ttfe_vbo_ensure_indices(TTFE_VBO* vbo, int needed);
 /* draw from a VertexArray */
 void ttfe_vbo_draw(TTFE_VBO* vbo, const ALLEGRO_VERTEX* verts, int count, int prim_type);
+/* draw from an indexed VertexArray */
+void ttfe_vbo_draw_indexed(TTFE_VBO* vbo, const ALLEGRO_VERTEX* verts, int count, const int* indices, int index_count, int prim_type);
+/* upload vertices (and indices if any) once into static buffers, returns false if no buffer could be created */
+bool ttfe_vbo_create_static(TTFE_VBO* vbo, const ALLEGRO_VERTEX* verts, int count, const int* indices, int index_count);
+/* draw a whole static buffer */
+void ttfe_vbo_draw_static(const TTFE_VBO* vbo, int prim_type);
+/* draw a whole static buffer with a texture */
+void ttfe_vbo_draw_static_textured(const TTFE_VBO* vbo, ALLEGRO_BITMAP* texture, int prim_type);
+/* draw count indices from first of an indexed static buffer, with an optional texture */
+void ttfe_vbo_draw_static_range(const TTFE_VBO* vbo, ALLEGRO_BITMAP* texture, int first, int count, int prim_type);
 
 #ifdef __cplusplus
 }
@@ -5,6 +5,9 @@
  *\date 04/12/2025
  */
 
+#include <string.h>
+#include <float.h>
+
 #include "ttfe_vector3d.h"
 
 /*
@@ -52,6 +55,10 @@ Vec3 v_make(float x, float y, float z) {
     return (Vec3){x, y, z};
 }
 
+Vec3 v_lerp(Vec3 a, Vec3 b, float t) {
+    return (Vec3){a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t};
+}
+
 /*
  * UTILITY FUNCTIONS
  */
@@ -113,10 +120,157 @@ void setup_3d_projection(float vertical_fov, float z_near, float z_far) {
     al_use_projection_transform(&projection);
 }
 
+static FrustumPlane frustum_plane(Vec3 n, Vec3 point) {
+    n = v_normalize(n);
+    return (FrustumPlane){n, -v_dot(n, point)};
+}
+
+/* view volume of setup_3d_projection seen from cam, aspect being display width / height */
+void frustum_from_camera(Frustum* fr, const Camera* cam, float aspect, float z_near, float z_far) {
+    Vec3 f = camera_forward(cam);
+    Vec3 r = camera_right(cam);
+    Vec3 u = camera_up(cam);
+
+    /* the projection moves the scene z_near away: the apex is z_near behind the camera,
+       and the half extents at the near plane are tan(fov / 2) high, aspect times that wide */
+    Vec3 apex = v_sub(cam->position, v_scale(f, z_near));
+    float th = tanf(cam->vertical_fov * 0.5f) / z_near;
+    float tw = th * aspect;
+
+    fr->planes[0] = frustum_plane(v_add(v_scale(f, tw), r), apex);
+    fr->planes[1] = frustum_plane(v_sub(v_scale(f, tw), r), apex);
+    fr->planes[2] = frustum_plane(v_add(v_scale(f, th), u), apex);
+    fr->planes[3] = frustum_plane(v_sub(v_scale(f, th), u), apex);
+    fr->planes[4] = frustum_plane(f, cam->position);
+    fr->planes[5] = frustum_plane(v_scale(f, -1.0f), v_add(apex, v_scale(f, z_far)));
+}
+
+/* false if the box is fully outside one of the planes */
+bool frustum_aabb_visible(const Frustum* fr, Vec3 min, Vec3 max) {
+    for (int i = 0; i < 6; i++) {
+        const FrustumPlane* p = &fr->planes[i];
+        /* corner furthest along the normal */
+        Vec3 c = {p->n.x >= 0.0f ? max.x : min.x,
+                  p->n.y >= 0.0f ? max.y : min.y,
+                  p->n.z >= 0.0f ? max.z : min.z};
+        if (v_dot(p->n, c) + p->d < 0.0f) return false;
+    }
+    return true;
+}
+
+/* false if the sphere is fully outside one of the planes */
+bool frustum_sphere_visible(const Frustum* fr, Vec3 center, float radius) {
+    for (int i = 0; i < 6; i++) {
+        if (v_dot(fr->planes[i].n, center) + fr->planes[i].d < -radius) return false;
+    }
+    return true;
+}
+
 /*
  * VOXEL FIELD
  */
 
+/* allocate the zeroed cells of a gw*gh field */
+bool voxel_field_alloc(VoxelField* vf) {
+    vf->cells = (unsigned char*)calloc((size_t)vf->gw * vf->gh, sizeof(unsigned char));
+    return vf->cells != NULL;
+}
+
+/* free the cells (and distance field) of a field */
+void voxel_field_free(VoxelField* vf) {
+    free(vf->cells);
+    free(vf->dist);
+    vf->cells = NULL;
+    vf->dist = NULL;
+}
+
+#define EDT_INF 1e20
+
+/* 1D squared distance transform of f (Felzenszwalb & Huttenlocher), v and z are n and n + 1 scratch */
+static void edt_1d(const double* f, double* d, int* v, double* z, int n) {
+    int k = 0;
+    v[0] = 0;
+    z[0] = -EDT_INF;
+    z[1] = EDT_INF;
+    for (int q = 1; q < n; q++) {
+        double s = ((f[q] + (double)q * q) - (f[v[k]] + (double)v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+        while (s <= z[k]) {
+            k--;
+            s = ((f[q] + (double)q * q) - (f[v[k]] + (double)v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = EDT_INF;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (z[k + 1] < q) k++;
+        d[q] = (double)(q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+/* build the distance field: per cell, a lower bound of the xz distance from its center to any solid cell */
+bool voxel_field_build_distance(VoxelField* vf) {
+    if (vf->gw <= 0 || vf->gh <= 0)
+        return false;
+
+    int n = vf->gw > vf->gh ? vf->gw : vf->gh;
+    double* grid = (double*)malloc(sizeof(double) * vf->gw * vf->gh);
+    double* f = (double*)calloc((size_t)n, sizeof(double));
+    double* d = (double*)calloc((size_t)n, sizeof(double));
+    double* z = (double*)calloc((size_t)n + 1, sizeof(double));
+    int* v = (int*)calloc((size_t)n, sizeof(int));
+    float* dist = (float*)realloc(vf->dist, sizeof(float) * vf->gw * vf->gh);
+    if (!grid || !f || !d || !z || !v || !dist) {
+        free(grid);
+        free(f);
+        free(d);
+        free(z);
+        free(v);
+        free(dist);
+        vf->dist = NULL;
+        return false;
+    }
+    vf->dist = dist;
+
+    /* squared distance in cells between cell centers: columns, then rows */
+    for (int i = 0; i < vf->gw * vf->gh; i++) grid[i] = (vf->cells[i] & VOXEL_SOLID) ? 0.0 : EDT_INF;
+    for (int gx = 0; gx < vf->gw; gx++) {
+        for (int gy = 0; gy < vf->gh; gy++) f[gy] = grid[gy * vf->gw + gx];
+        edt_1d(f, d, v, z, vf->gh);
+        for (int gy = 0; gy < vf->gh; gy++) grid[gy * vf->gw + gx] = d[gy];
+    }
+    for (int gy = 0; gy < vf->gh; gy++) {
+        edt_1d(grid + gy * vf->gw, d, v, z, vf->gw);
+        memcpy(grid + gy * vf->gw, d, sizeof(double) * vf->gw);
+    }
+
+    /* a solid cell reaches half a diagonal out of its center */
+    float half_diag = vf->cell_size * 0.70710678f;
+    for (int i = 0; i < vf->gw * vf->gh; i++) dist[i] = (float)sqrt(grid[i]) * vf->cell_size - half_diag;
+
+    free(grid);
+    free(f);
+    free(d);
+    free(z);
+    free(v);
+    return true;
+}
+
+/* lower bound of the xz distance from (x, z) to the nearest solid cell. Needs the distance field */
+float voxel_field_clearance(const VoxelField* vf, float x, float z) {
+    int gx, gy;
+    world_to_grid(vf, x, z, &gx, &gy);
+    gx = gx < 0 ? 0 : (gx >= vf->gw ? vf->gw - 1 : gx);
+    gy = gy < 0 ? 0 : (gy >= vf->gh ? vf->gh - 1 : gy);
+
+    /* triangle inequality through the center of the nearest cell */
+    float dx = x - (vf->origin_x + (gx + 0.5f) * vf->cell_size);
+    float dz = z - (vf->origin_z + (gy + 0.5f) * vf->cell_size);
+    return vf->dist[gy * vf->gw + gx] - sqrtf(dx * dx + dz * dz);
+}
+
 void world_to_grid(const VoxelField* vf, float x, float z, int* gx, int* gy) {
     float fx = x / vf->cell_size + (float)vf->gw * 0.5f;
     float fz = z / vf->cell_size + (float)vf->gh * 0.5f;
@@ -124,10 +278,19 @@ void world_to_grid(const VoxelField* vf, float x, float z, int* gx, int* gy) {
     *gy = (int)floorf(fz);
 }
 
-int is_solid(const VoxelField* vf, int gx, int gy) {
+/* VOXEL_* flags of a cell, 0 outside of the grid */
+unsigned char voxel_cell(const VoxelField* vf, int gx, int gy) {
     if (gx < 0 || gx >= vf->gw || gy < 0 || gy >= vf->gh)
         return 0;
-    return vf->solid[gy * vf->gw + gx] != 0;
+    return vf->cells[gy * vf->gw + gx];
+}
+
+int is_solid(const VoxelField* vf, int gx, int gy) {
+    return (voxel_cell(vf, gx, gy) & VOXEL_SOLID) != 0;
+}
+
+int is_goal(const VoxelField* vf, int gx, int gy) {
+    return (voxel_cell(vf, gx, gy) & VOXEL_GOAL) != 0;
 }
 
 /* Capsule (vertical cylinder) vs voxel grid collision */
@@ -138,6 +301,24 @@ bool capsule_collides(const VoxelField* vf, Vec3 pos, float radius, float half_h
     if (top <= 0.0f || bottom >= vf->extrude_h)
         return false;
 
+    /* one lookup instead of the cell scan when the center cell answers it */
+    if (vf->dist) {
+        int cx, cy;
+        world_to_grid(vf, pos.x, pos.z, &cx, &cy);
+        cx = cx < 0 ? 0 : (cx >= vf->gw ? vf->gw - 1 : cx);
+        cy = cy < 0 ? 0 : (cy >= vf->gh ? vf->gh - 1 : cy);
+        float dx = pos.x - (vf->origin_x + (cx + 0.5f) * vf->cell_size);
+        float dz = pos.z - (vf->origin_z + (cy + 0.5f) * vf->cell_size);
+        float d2 = dx * dx + dz * dz;
+        float margin = vf->dist[cy * vf->gw + cx] - radius - 1e-3f;
+        /* center inside a solid cell */
+        if ((vf->cells[cy * vf->gw + cx] & VOXEL_SOLID) && fabsf(dx) <= vf->cell_size * 0.5f && fabsf(dz) <= vf->cell_size * 0.5f)
+            return true;
+        /* clearance (see voxel_field_clearance) above radius, compared squared */
+        if (margin > 0.0f && margin * margin > d2)
+            return false;
+    }
+
     float minx = pos.x - radius;
     float maxx = pos.x + radius;
     float minz = pos.z - radius;
@@ -166,8 +347,10 @@ bool capsule_collides(const VoxelField* vf, Vec3 pos, float radius, float half_h
     float r2 = radius * radius;
 
     for (int gy = gy_min; gy <= gy_max; ++gy) {
+        /* bounds are clamped above, read the row directly */
+        const unsigned char* row = vf->cells + gy * vf->gw;
         for (int gx = gx_min; gx <= gx_max; ++gx) {
-            if (!is_solid(vf, gx, gy))
+            if (!(row[gx] & VOXEL_SOLID))
                 continue;
 
             float x0 = vf->origin_x + gx * vf->cell_size;
@@ -187,6 +370,36 @@ bool capsule_collides(const VoxelField* vf, Vec3 pos, float radius, float half_h
     return false;
 }
 
+/* Swept capsule vs voxel grid: fraction of the from -> to move before the first contact, 1 if free.
+ * Samples are at most radius / 2 apart, longer steps are taken through free space when the
+ * distance field exists. A capsule that starts in contact only tests the end, so it can move out */
+float capsule_sweep(const VoxelField* vf, Vec3 from, Vec3 to, float radius, float half_height) {
+    if (capsule_collides(vf, from, radius, half_height))
+        return capsule_collides(vf, to, radius, half_height) ? 0.0f : 1.0f;
+
+    Vec3 move = v_sub(to, from);
+    float len = v_norm(move);
+    if (len < 1e-6f)
+        return 1.0f;
+
+    float min_step = radius * 0.5f > 1e-3f ? radius * 0.5f : 1e-3f;
+    float t = 0.0f;
+    while (t < 1.0f) {
+        float step = min_step;
+        if (vf->dist) {
+            Vec3 p = v_add(from, v_scale(move, t));
+            float free_dist = voxel_field_clearance(vf, p.x, p.z) - radius;
+            if (free_dist > step) step = free_dist;
+        }
+        float next = t + step / len;
+        if (next > 1.0f) next = 1.0f;
+        if (capsule_collides(vf, v_add(from, v_scale(move, next)), radius, half_height))
+            return t;
+        t = next;
+    }
+    return 1.0f;
+}
+
 /* Capsule (vertical cylinder) vs AABB */
 bool capsule_aabb_collides(Vec3 pos, float radius, float half_height, Vec3 box_pos, float b_half) {
     /* Box bounds */
@@ -217,6 +430,81 @@ bool capsule_aabb_collides(Vec3 pos, float radius, float half_height, Vec3 box_p
     return (dx * dx + dz * dz + dy * dy) <= r2;
 }
 
+/* clip [*t0, *t1] of o + d * t to the slab [lo, hi] of one axis */
+static bool slab_clip(float o, float d, float lo, float hi, float* t0, float* t1) {
+    if (d == 0.0f)
+        return o >= lo && o <= hi;
+    float inv = 1.0f / d;
+    float ta = (lo - o) * inv;
+    float tb = (hi - o) * inv;
+    if (ta > tb) {
+        float tmp = ta;
+        ta = tb;
+        tb = tmp;
+    }
+    if (ta > *t0) *t0 = ta;
+    if (tb < *t1) *t1 = tb;
+    return *t0 <= *t1;
+}
+
+/* Segment vs AABB (slab test): fraction of from -> to where the segment enters the box, 0 if from is inside */
+bool segment_aabb_hit(Vec3 from, Vec3 to, Vec3 box_pos, float b_half, float* t_hit) {
+    float t0 = 0.0f, t1 = 1.0f;
+    if (!slab_clip(from.x, to.x - from.x, box_pos.x - b_half, box_pos.x + b_half, &t0, &t1) ||
+        !slab_clip(from.y, to.y - from.y, box_pos.y - b_half, box_pos.y + b_half, &t0, &t1) ||
+        !slab_clip(from.z, to.z - from.z, box_pos.z - b_half, box_pos.z + b_half, &t0, &t1))
+        return false;
+    *t_hit = t0;
+    return true;
+}
+
+/* Segment vs solid cells (Amanatides-Woo traversal): fraction of from -> to where the segment enters the first solid cell */
+bool voxel_ray_cast(const VoxelField* vf, Vec3 from, Vec3 to, float* t_hit) {
+    if (!vf->cells || vf->gw <= 0 || vf->gh <= 0) return false;
+
+    /* clip to the extruded field, outside of it nothing is solid */
+    float cs = vf->cell_size;
+    Vec3 d = v_sub(to, from);
+    float t0 = 0.0f, t1 = 1.0f;
+    if (!slab_clip(from.x, d.x, vf->origin_x, vf->origin_x + vf->gw * cs, &t0, &t1) ||
+        !slab_clip(from.y, d.y, 0.0f, vf->extrude_h, &t0, &t1) ||
+        !slab_clip(from.z, d.z, vf->origin_z, vf->origin_z + vf->gh * cs, &t0, &t1))
+        return false;
+
+    /* entry cell, clamped as the entry point may sit on the far border */
+    int gx = (int)floorf((from.x + d.x * t0 - vf->origin_x) / cs);
+    int gy = (int)floorf((from.z + d.z * t0 - vf->origin_z) / cs);
+    gx = gx < 0 ? 0 : (gx >= vf->gw ? vf->gw - 1 : gx);
+    gy = gy < 0 ? 0 : (gy >= vf->gh ? vf->gh - 1 : gy);
+
+    /* t of the next cell border crossed on each axis, and t between two borders */
+    int step_x = d.x > 0.0f ? 1 : (d.x < 0.0f ? -1 : 0);
+    int step_y = d.z > 0.0f ? 1 : (d.z < 0.0f ? -1 : 0);
+    float t_max_x = step_x ? (vf->origin_x + (gx + (step_x > 0)) * cs - from.x) / d.x : FLT_MAX;
+    float t_max_y = step_y ? (vf->origin_z + (gy + (step_y > 0)) * cs - from.z) / d.z : FLT_MAX;
+    float t_delta_x = step_x ? cs / fabsf(d.x) : FLT_MAX;
+    float t_delta_y = step_y ? cs / fabsf(d.z) : FLT_MAX;
+
+    float t = t0;
+    for (;;) {
+        if (vf->cells[gy * vf->gw + gx] & VOXEL_SOLID) {
+            *t_hit = t;
+            return true;
+        }
+        if (t_max_x < t_max_y) {
+            gx += step_x;
+            t = t_max_x;
+            t_max_x += t_delta_x;
+        } else {
+            gy += step_y;
+            t = t_max_y;
+            t_max_y += t_delta_y;
+        }
+        if (t > t1 || gx < 0 || gx >= vf->gw || gy < 0 || gy >= vf->gh)
+            return false;
+    }
+}
+
 /*
  * VERTEX ARRAY (Dynamic)
  */
@@ -225,16 +513,23 @@ void va_init(VertexArray* va, int initial_capacity) {
     va->count = 0;
     va->capacity = initial_capacity;
     va->v = (ALLEGRO_VERTEX*)malloc(sizeof(ALLEGRO_VERTEX) * initial_capacity);
+    va->index_count = 0;
+    va->index_capacity = initial_capacity + initial_capacity / 2; /* 6 indices per 4 vertices */
+    va->indices = (int*)malloc(sizeof(int) * va->index_capacity);
 }
 
 void va_free(VertexArray* va) {
     free(va->v);
     va->v = NULL;
     va->count = va->capacity = 0;
+    free(va->indices);
+    va->indices = NULL;
+    va->index_count = va->index_capacity = 0;
 }
 
 void va_clear(VertexArray* va) {
     va->count = 0;
+    va->index_count = 0;
 }
 
 void va_reserve(VertexArray* va, int extra) {
@@ -247,6 +542,31 @@ void va_reserve(VertexArray* va, int extra) {
     va->capacity = newcap;
 }
 
+void va_reserve_indices(VertexArray* va, int extra) {
+    if (va->index_count + extra <= va->index_capacity)
+        return;
+    int newcap = va->index_capacity * 2;
+    if (newcap < va->index_count + extra)
+        newcap = va->index_count + extra;
+    va->indices = (int*)realloc(va->indices, sizeof(int) * newcap);
+    va->index_capacity = newcap;
+}
+
+/* add the 6 indices of the quad made of the 4 vertices starting at base */
+void va_add_quad_indices(VertexArray* va, int base) {
+    va_reserve_indices(va, 6);
+    int* i = va->indices + va->index_count;
+
+    i[0] = base;
+    i[1] = base + 1;
+    i[2] = base + 2;
+    i[3] = base;
+    i[4] = base + 2;
+    i[5] = base + 3;
+
+    va->index_count += 6;
+}
+
 void va_push_vertex(VertexArray* va, float x, float y, float z, float u, float v, ALLEGRO_COLOR color) {
     va_reserve(va, 1);
     ALLEGRO_VERTEX* vert = &va->v[va->count++];
@@ -272,20 +592,38 @@ void va_add_quad(VertexArray* va,
                  float y4,
                  float z4,
                  ALLEGRO_COLOR color) {
-    va_reserve(va, 6);
+    va_reserve(va, 4);
     ALLEGRO_VERTEX* v = va->v + va->count;
 
     v[0] = (ALLEGRO_VERTEX){x1, y1, z1, 0, 0, color};
     v[1] = (ALLEGRO_VERTEX){x2, y2, z2, 0, 0, color};
     v[2] = (ALLEGRO_VERTEX){x3, y3, z3, 0, 0, color};
-    v[3] = (ALLEGRO_VERTEX){x1, y1, z1, 0, 0, color};
-    v[4] = (ALLEGRO_VERTEX){x3, y3, z3, 0, 0, color};
-    v[5] = (ALLEGRO_VERTEX){x4, y4, z4, 0, 0, color};
+    v[3] = (ALLEGRO_VERTEX){x4, y4, z4, 0, 0, color};
 
-    va->count += 6;
+    va_add_quad_indices(va, va->count);
+    va->count += 4;
 }
 
 void vbo_draw(TTFE_VBO* vbo, const VertexArray* va, int type) {
     if (!va || va->count < 0) return;
+    if (va->index_count > 0) {
+        ttfe_vbo_draw_indexed(vbo, va->v, va->count, va->indices, va->index_count, type);
+        return;
+    }
     ttfe_vbo_draw(vbo, va->v, va->count, type);
 }
+
+/* upload a VertexArray that won't change anymore into a static buffer */
+bool vbo_upload_static(TTFE_VBO* vbo, const VertexArray* va) {
+    if (!va) return false;
+    return ttfe_vbo_create_static(vbo, va->v, va->count, va->indices, va->index_count);
+}
+
+/* draw the static buffer if any, else stream the VertexArray through the fallback VBO */
+void vbo_draw_static(const TTFE_VBO* vbo, TTFE_VBO* fallback, const VertexArray* va, int type) {
+    if (vbo->vb) {
+        ttfe_vbo_draw_static(vbo, type);
+        return;
+    }
+    vbo_draw(fallback, va, type);
+}
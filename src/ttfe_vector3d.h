@@ -43,6 +43,7 @@ float v_norm(Vec3 a);
 Vec3 v_normalize(Vec3 a);
 Vec3 v_zero(void);
 Vec3 v_make(float x, float y, float z);
+Vec3 v_lerp(Vec3 a, Vec3 b, float t);
 
 /*
  * UTILITY FUNCTIONS
@@ -69,6 +70,24 @@ Vec3 camera_up(const Camera* cam);
 /* Projection similar to Allegro ex_camera.c */
 void setup_3d_projection(float vertical_fov, float z_near, float z_far);
 
+/* inward facing plane: dot(n, p) + d >= 0 on the inside */
+typedef struct {
+    Vec3 n;
+    float d;
+} FrustumPlane;
+
+/* left, right, bottom, top, near, far */
+typedef struct {
+    FrustumPlane planes[6];
+} Frustum;
+
+/* view volume of setup_3d_projection seen from cam, aspect being display width / height */
+void frustum_from_camera(Frustum* fr, const Camera* cam, float aspect, float z_near, float z_far);
+/* false if the box is fully outside one of the planes */
+bool frustum_aabb_visible(const Frustum* fr, Vec3 min, Vec3 max);
+/* false if the sphere is fully outside one of the planes */
+bool frustum_sphere_visible(const Frustum* fr, Vec3 center, float radius);
+
 /*
  * VOXEL FIELD
  */
@@ -78,16 +97,37 @@ typedef struct {
     float cell_size;          /* world size of one cell */
     float extrude_h;          /* height of extrusion */
     float origin_x, origin_z; /* world coord of cell (0,0) left/back corner */
-    int* solid;               /* gw*gh, 0 = empty, 1 = solid */
-    int* is_goal;             /* gw*gh, 1 = goal character */
+    unsigned char* cells;     /* gw*gh VOXEL_* flags, one byte per cell */
+    float* dist;              /* optional gw*gh distance field, see voxel_field_build_distance */
 } VoxelField;
 
+/* voxel cell flags */
+#define VOXEL_SOLID 0x01
+#define VOXEL_GOAL 0x02
+
+/* allocate the zeroed cells of a gw*gh field */
+bool voxel_field_alloc(VoxelField* vf);
+/* free the cells (and distance field) of a field */
+void voxel_field_free(VoxelField* vf);
+/* build the distance field: per cell, a lower bound of the xz distance from its center to any solid cell */
+bool voxel_field_build_distance(VoxelField* vf);
+/* lower bound of the xz distance from (x, z) to the nearest solid cell. Needs the distance field */
+float voxel_field_clearance(const VoxelField* vf, float x, float z);
 void world_to_grid(const VoxelField* vf, float x, float z, int* gx, int* gy);
+/* VOXEL_* flags of a cell, 0 outside of the grid */
+unsigned char voxel_cell(const VoxelField* vf, int gx, int gy);
 int is_solid(const VoxelField* vf, int gx, int gy);
+int is_goal(const VoxelField* vf, int gx, int gy);
 /* Capsule (vertical cylinder) vs voxel grid collision */
 bool capsule_collides(const VoxelField* vf, Vec3 pos, float radius, float half_height);
+/* Swept capsule vs voxel grid: fraction of the from -> to move before the first contact, 1 if free */
+float capsule_sweep(const VoxelField* vf, Vec3 from, Vec3 to, float radius, float half_height);
 /* Capsule (vertical cylinder) vs AABB collision */
 bool capsule_aabb_collides(Vec3 pos, float radius, float half_height, Vec3 box_pos, float b_half);
+/* Segment vs AABB (slab test): fraction of from -> to where the segment enters the box, 0 if from is inside */
+bool segment_aabb_hit(Vec3 from, Vec3 to, Vec3 box_pos, float b_half, float* t_hit);
+/* Segment vs solid cells (Amanatides-Woo traversal): fraction of from -> to where the segment enters the first solid cell */
+bool voxel_ray_cast(const VoxelField* vf, Vec3 from, Vec3 to, float* t_hit);
 
 /*
  * VERTEX ARRAY (Dynamic)
@@ -97,12 +137,18 @@ typedef struct {
     ALLEGRO_VERTEX* v;
     int count;
     int capacity;
+    int* indices;       /* triangle list indices, unused when index_count == 0 */
+    int index_count;
+    int index_capacity;
 } VertexArray;
 
 void va_init(VertexArray* va, int initial_capacity);
 void va_free(VertexArray* va);
 void va_clear(VertexArray* va);
 void va_reserve(VertexArray* va, int extra);
+void va_reserve_indices(VertexArray* va, int extra);
+/* add the 6 indices of the quad made of the 4 vertices starting at base */
+void va_add_quad_indices(VertexArray* va, int base);
 void va_push_vertex(VertexArray* va, float x, float y, float z, float u, float v, ALLEGRO_COLOR color);
 
 void va_add_quad(VertexArray* va,
@@ -120,6 +166,10 @@ void va_add_quad(VertexArray* va,
                  float z4,
                  ALLEGRO_COLOR color);
 void vbo_draw(TTFE_VBO* vbo, const VertexArray* va, int type);
+/* upload a VertexArray that won't change anymore into a static buffer */
+bool vbo_upload_static(TTFE_VBO* vbo, const VertexArray* va);
+/* draw the static buffer if any, else stream the VertexArray through the fallback VBO */
+void vbo_draw_static(const TTFE_VBO* vbo, TTFE_VBO* fallback, const VertexArray* va, int type);
 
 #ifdef __cplusplus
 }